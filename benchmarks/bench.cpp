@@ -0,0 +1,508 @@
+#include <benchmark/benchmark.h>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include "block_splay_tree.hpp"
+#include "combining_splay_tree.hpp"
+#include "concurrent_splay_tree.hpp"
+#include "sharded_splay_tree.hpp"
+#include "../end-to-end/boost-set/include/boost_set.hpp"
+#include "distributions.hpp"
+
+namespace
+{
+
+using Workload::Distribution;
+
+using Splay  = Container::SplayTree<int>;
+using Search = Container::SearchTree<int>;
+using Boost  = Container::BoostSet<int>;
+using StdSet = std::set<int>;
+using Frozen = Container::FrozenSet<int>;
+using Compressed = Container::EliasFanoSet<int>;
+using Learned = Container::LearnedSet<int>;
+using Block = Container::BlockSplayTree<int>;
+using Sharded = Container::ShardedSplayTree<int>;
+using Concurrent = Container::ConcurrentSplayTree<int>;
+using Combining = Container::CombiningSplayTree<int>;
+
+constexpr std::uint64_t seed = 42;
+
+constexpr std::size_t probes_per_iteration = 1 << 12;
+
+// keys and requests of test_gen.py, generated once for every size and distribution
+struct Data
+{
+    std::vector<int> keys_;
+    std::vector<std::pair<int, int>> reqs_;
+};
+
+const Data& data(std::size_t size, Distribution dist)
+{
+    static std::map<std::pair<std::size_t, Distribution>, Data> cache {};
+    // threads of concurrent benchmarks ask for data at once
+    static std::mutex mutex {};
+
+    std::lock_guard lock {mutex};
+    auto [itr, inserted] = cache.try_emplace(std::pair{size, dist});
+    if (inserted)
+    {
+        Workload::Random rand {seed};
+        auto& data = itr->second;
+        data.keys_ = Workload::generate_keys(rand, size);
+        auto [min, max] = std::minmax_element(data.keys_.begin(), data.keys_.end());
+        data.reqs_ = Workload::generate_requests(rand, dist, probes_per_iteration, *min, *max);
+    }
+    return itr->second;
+}
+
+const Data& data(const benchmark::State& state)
+{
+    return data(state.range(0), static_cast<Distribution>(state.range(1)));
+}
+
+template<typename Set>
+Set make_set(const std::vector<int>& keys)
+{
+    Set set {};
+    for (auto key: keys)
+        set.insert(key);
+    return set;
+}
+
+// immutable sets are built once from all keys
+template<>
+Frozen make_set<Frozen>(const std::vector<int>& keys)
+{
+    return Frozen(keys.begin(), keys.end());
+}
+
+template<>
+Compressed make_set<Compressed>(const std::vector<int>& keys)
+{
+    return Compressed(keys.begin(), keys.end());
+}
+
+template<>
+Learned make_set<Learned>(const std::vector<int>& keys)
+{
+    return Learned(keys.begin(), keys.end());
+}
+
+// trees with sizes of subtrees in nodes
+template<typename Set>
+concept ranked = requires(const Set& set, int key) {set.number_less_than(key); set.number_not_greater_than(key);};
+
+//----------------------------------------=| Benchmarks start |=----------------------------------------
+template<typename Set>
+void insert(benchmark::State& state)
+{
+    auto& keys = data(state).keys_;
+    for (auto _: state)
+    {
+        Set set {};
+        for (auto key: keys)
+            set.insert(key);
+        benchmark::DoNotOptimize(set);
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// parallel construction of balanced tree, second argument is number of threads
+template<typename Set>
+void build(benchmark::State& state)
+{
+    auto& keys = data(state.range(0), Distribution::Uniform).keys_;
+    for (auto _: state)
+    {
+        Set set {};
+        set.build_from(keys.begin(), keys.end(), state.range(1));
+        benchmark::DoNotOptimize(set);
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template<typename Set>
+void find(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    for (auto _: state)
+        for (auto [left, right]: reqs)
+            benchmark::DoNotOptimize(set.find(left));
+    state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+template<typename Set>
+void lower_bound(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    for (auto _: state)
+        for (auto [left, right]: reqs)
+            benchmark::DoNotOptimize(set.lower_bound(left));
+    state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+template<ranked Set>
+void rank(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    for (auto _: state)
+        for (auto [left, right]: reqs)
+            benchmark::DoNotOptimize(set.number_less_than(left));
+    state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+template<ranked Set>
+void range_count(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    for (auto _: state)
+        for (auto [left, right]: reqs)
+            benchmark::DoNotOptimize(set.number_not_greater_than(right) - set.number_less_than(left));
+    state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+// the same probes as lower_bound and rank, answered by one batch with interleaved descents
+template<typename Set>
+void lower_bound_batch(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    std::vector<int> probes {};
+    for (auto [left, right]: reqs)
+        probes.push_back(left);
+    for (auto _: state)
+        benchmark::DoNotOptimize(set.lower_bound_batch(probes.begin(), probes.end()));
+    state.SetItemsProcessed(state.iterations() * probes.size());
+}
+
+template<ranked Set>
+void rank_batch(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    std::vector<int> probes {};
+    for (auto [left, right]: reqs)
+        probes.push_back(left);
+    for (auto _: state)
+        benchmark::DoNotOptimize(set.rank_batch(probes.begin(), probes.end()));
+    state.SetItemsProcessed(state.iterations() * probes.size());
+}
+
+// sorted probes of analytics jobs, answered by one descent for all of them
+template<typename Set>
+void find_sorted_batch(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    std::vector<int> probes {};
+    for (auto [left, right]: reqs)
+        probes.push_back(left);
+    std::sort(probes.begin(), probes.end());
+    for (auto _: state)
+        benchmark::DoNotOptimize(set.find_sorted_batch(probes.begin(), probes.end()));
+    state.SetItemsProcessed(state.iterations() * probes.size());
+}
+
+template<ranked Set>
+void rank_sorted_batch(benchmark::State& state)
+{
+    auto& [keys, reqs] = data(state);
+    auto set = make_set<Set>(keys);
+    std::vector<int> probes {};
+    for (auto [left, right]: reqs)
+        probes.push_back(left);
+    std::sort(probes.begin(), probes.end());
+    for (auto _: state)
+        benchmark::DoNotOptimize(set.rank_sorted_batch(probes.begin(), probes.end()));
+    state.SetItemsProcessed(state.iterations() * probes.size());
+}
+
+template<typename Set>
+void erase(benchmark::State& state)
+{
+    auto& keys = data(state).keys_;
+    auto origin = make_set<Set>(keys);
+    for (auto _: state)
+    {
+        state.PauseTiming();
+        auto set {origin};
+        state.ResumeTiming();
+        for (auto key: keys)
+            set.erase(key);
+        benchmark::DoNotOptimize(set);
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template<typename Set>
+void iteration(benchmark::State& state)
+{
+    auto& keys = data(state).keys_;
+    auto set = make_set<Set>(keys);
+    for (auto _: state)
+        for (auto& key: set)
+            benchmark::DoNotOptimize(key);
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// merge of sorted sequences into third set, as before split/join algebra of SplayTree
+StdSet unite(StdSet lhs, StdSet rhs, unsigned)
+{
+    StdSet result {};
+    std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(result, result.end()));
+    return result;
+}
+
+Splay unite(Splay lhs, Splay rhs, unsigned threads)
+{
+    return set_union(std::move(lhs), std::move(rhs), threads);
+}
+
+// union of two sets with half of keys in common, second argument is number of threads
+template<typename Set>
+void union_of(benchmark::State& state)
+{
+    auto& keys = data(state.range(0), Distribution::Uniform).keys_;
+    auto quarter = keys.size() / 4;
+    auto lhs_origin = make_set<Set>({keys.begin(), keys.end() - quarter});
+    auto rhs_origin = make_set<Set>({keys.begin() + quarter, keys.end()});
+    for (auto _: state)
+    {
+        state.PauseTiming();
+        auto lhs {lhs_origin}, rhs {rhs_origin};
+        state.ResumeTiming();
+        auto result = unite(std::move(lhs), std::move(rhs), state.range(1));
+        benchmark::DoNotOptimize(result);
+        state.PauseTiming();
+        {auto drop = std::move(result);}
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// one splay tree for all threads: every query is a write, so it is behind mutex
+struct LockedSplay
+{
+    std::mutex mutex_;
+    Splay set_;
+
+    explicit LockedSplay(const std::vector<int>& keys): set_ {make_set<Splay>(keys)} {}
+
+    std::size_t count_in_range(int left, int right)
+    {
+        std::lock_guard lock {mutex_};
+        return set_.number_not_greater_than(right) - set_.number_less_than(left);
+    }
+
+    bool contains(int key)
+    {
+        std::lock_guard lock {mutex_};
+        return set_.find(key) != set_.end();
+    }
+
+    bool insert(int key)
+    {
+        std::lock_guard lock {mutex_};
+        return set_.insert(key).second;
+    }
+
+    bool erase(int key)
+    {
+        std::lock_guard lock {mutex_};
+        auto itr = set_.find(key);
+        if (itr == set_.end())
+            return false;
+        set_.erase(itr);
+        return true;
+    }
+};
+
+// range counts from all threads of benchmark to one shared set
+template<typename Set>
+void concurrent_range_count(benchmark::State& state)
+{
+    static std::unique_ptr<Set> set {};
+    auto& [keys, reqs] = data(state.range(0), Distribution::Uniform);
+    // loop starts by barrier after setup of first thread
+    if (state.thread_index() == 0)
+    {
+        if constexpr (std::is_same_v<Set, Sharded>)
+            set = std::make_unique<Set>(keys.begin(), keys.end(), 16);
+        else
+            set = std::make_unique<Set>(keys);
+    }
+
+    auto offset = reqs.size() * state.thread_index() / state.threads();
+    for (auto _: state)
+        for (std::size_t i = 0; i < reqs.size(); i++)
+        {
+            auto [left, right] = reqs[(offset + i) % reqs.size()];
+            benchmark::DoNotOptimize(set->count_in_range(left, right));
+        }
+    state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+// lookups of left bounds of skewed requests from all threads of benchmark to one shared set
+template<typename Set>
+void concurrent_find(benchmark::State& state)
+{
+    static std::unique_ptr<Set> set {};
+    auto& [keys, reqs] = data(state.range(0), Distribution::Normal);
+    if (state.thread_index() == 0)
+    {
+        if constexpr (std::is_same_v<Set, Concurrent>)
+        {
+            set = std::make_unique<Set>();
+            for (auto key: keys)
+                set->insert(key);
+        }
+        else
+            set = std::make_unique<Set>(keys);
+    }
+
+    auto offset = reqs.size() * state.thread_index() / state.threads();
+    for (auto _: state)
+        for (std::size_t i = 0; i < reqs.size(); i++)
+        {
+            auto [left, right] = reqs[(offset + i) % reqs.size()];
+            benchmark::DoNotOptimize(set->contains(left));
+        }
+    state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+// every thread of benchmark inserts keys and erases them back in one shared set
+template<typename Set>
+void concurrent_updates(benchmark::State& state)
+{
+    static std::unique_ptr<Set> set {};
+    auto& keys = data(state.range(0), Distribution::Uniform).keys_;
+    if (state.thread_index() == 0)
+    {
+        if constexpr (std::is_same_v<Set, Combining>)
+            set = std::make_unique<Set>();
+        else
+            set = std::make_unique<Set>(std::vector<int>{});
+    }
+
+    // threads work with disjoint parts of keys
+    auto first = keys.size() * state.thread_index() / state.threads();
+    auto last  = keys.size() * (state.thread_index() + 1) / state.threads();
+    for (auto _: state)
+    {
+        for (auto i = first; i < last; i++)
+            set->insert(keys[i]);
+        for (auto i = first; i < last; i++)
+            set->erase(keys[i]);
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * (last - first));
+}
+
+//----------------------------------------=| Benchmarks end |=------------------------------------------
+
+// sizes of sets, distribution of probes matters only for lookups
+void sizes(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"size", "dist"});
+    for (auto size: {1 << 10, 1 << 14, 1 << 18})
+        bench->Args({size, static_cast<long>(Distribution::Uniform)});
+}
+
+void sizes_n_distributions(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"size", "dist"});
+    for (auto size: {1 << 10, 1 << 14, 1 << 18})
+        for (auto dist: {Distribution::Uniform, Distribution::Normal, Distribution::Triangular})
+            bench->Args({size, static_cast<long>(dist)});
+}
+
+void sizes_n_threads(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"size", "threads"})->UseRealTime();
+    for (auto size: {1 << 14, 1 << 18, 1 << 20})
+        for (auto threads: {1, 2, 4})
+            bench->Args({size, threads});
+}
+} // namespace
+
+#define SET_BENCHMARK(func, set, args) BENCHMARK_TEMPLATE(func, set)->Name(#func "/" #set)->Apply(args)
+
+SET_BENCHMARK(insert, Splay,  sizes);
+SET_BENCHMARK(insert, Search, sizes);
+SET_BENCHMARK(insert, Boost,  sizes);
+SET_BENCHMARK(insert, StdSet, sizes);
+SET_BENCHMARK(insert, Block,  sizes);
+
+SET_BENCHMARK(build, Splay,  sizes_n_threads);
+SET_BENCHMARK(build, Search, sizes_n_threads);
+
+SET_BENCHMARK(find, Splay,  sizes_n_distributions);
+SET_BENCHMARK(find, Search, sizes_n_distributions);
+SET_BENCHMARK(find, Boost,  sizes_n_distributions);
+SET_BENCHMARK(find, StdSet, sizes_n_distributions);
+
+SET_BENCHMARK(lower_bound, Splay,  sizes_n_distributions);
+SET_BENCHMARK(lower_bound, Search, sizes_n_distributions);
+SET_BENCHMARK(lower_bound, Boost,  sizes_n_distributions);
+SET_BENCHMARK(lower_bound, StdSet, sizes_n_distributions);
+SET_BENCHMARK(lower_bound, Frozen, sizes_n_distributions);
+SET_BENCHMARK(lower_bound, Learned, sizes_n_distributions);
+
+// rank of std::set and SearchTree is linear (std::distance), so they are not compared
+SET_BENCHMARK(rank, Splay, sizes_n_distributions);
+SET_BENCHMARK(rank, Boost, sizes_n_distributions);
+SET_BENCHMARK(rank, Frozen, sizes_n_distributions);
+SET_BENCHMARK(rank, Compressed, sizes_n_distributions);
+SET_BENCHMARK(rank, Learned, sizes_n_distributions);
+SET_BENCHMARK(rank, Block, sizes_n_distributions);
+
+SET_BENCHMARK(range_count, Splay, sizes_n_distributions);
+SET_BENCHMARK(range_count, Boost, sizes_n_distributions);
+SET_BENCHMARK(range_count, Frozen, sizes_n_distributions);
+SET_BENCHMARK(range_count, Compressed, sizes_n_distributions);
+SET_BENCHMARK(range_count, Learned, sizes_n_distributions);
+SET_BENCHMARK(range_count, Block, sizes_n_distributions);
+
+SET_BENCHMARK(lower_bound_batch, Splay,  sizes_n_distributions);
+SET_BENCHMARK(lower_bound_batch, Search, sizes_n_distributions);
+SET_BENCHMARK(rank_batch, Splay, sizes_n_distributions);
+
+SET_BENCHMARK(find_sorted_batch, Splay,  sizes_n_distributions);
+SET_BENCHMARK(find_sorted_batch, Search, sizes_n_distributions);
+SET_BENCHMARK(rank_sorted_batch, Splay, sizes_n_distributions);
+
+SET_BENCHMARK(erase, Splay,  sizes);
+SET_BENCHMARK(erase, Search, sizes);
+SET_BENCHMARK(erase, Boost,  sizes);
+SET_BENCHMARK(erase, StdSet, sizes);
+
+SET_BENCHMARK(iteration, Splay,  sizes);
+SET_BENCHMARK(iteration, Search, sizes);
+SET_BENCHMARK(iteration, Boost,  sizes);
+SET_BENCHMARK(iteration, StdSet, sizes);
+
+SET_BENCHMARK(union_of, Splay,  sizes_n_threads);
+SET_BENCHMARK(union_of, StdSet, sizes);
+
+BENCHMARK_TEMPLATE(concurrent_range_count, Sharded)->Name("concurrent_range_count/Sharded")
+    ->Arg(1 << 18)->ArgName("size")->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_range_count, LockedSplay)->Name("concurrent_range_count/LockedSplay")
+    ->Arg(1 << 18)->ArgName("size")->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_TEMPLATE(concurrent_find, Concurrent)->Name("concurrent_find/Concurrent")
+    ->Arg(1 << 18)->ArgName("size")->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_find, LockedSplay)->Name("concurrent_find/LockedSplay")
+    ->Arg(1 << 18)->ArgName("size")->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_TEMPLATE(concurrent_updates, Combining)->Name("concurrent_updates/Combining")
+    ->Arg(1 << 16)->ArgName("size")->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_updates, LockedSplay)->Name("concurrent_updates/LockedSplay")
+    ->Arg(1 << 16)->ArgName("size")->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
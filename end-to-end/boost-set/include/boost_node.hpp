@@ -91,6 +91,31 @@ public:
         for (auto node = this; node != Null; node = node->parent_)
             node->size_++;
     }
+
+    void action_before_erase(node_ptr Null) noexcept
+    {
+        for (auto node = this; node != Null; node = node->parent_)
+            node->size_--;
+    }
+
+    // node took place of other in tree
+    void action_after_replace(node_ptr other) noexcept
+    {
+        size_ = other->size_;
+    }
+
+    // node is moved from other tree, action_before_insert counts it again
+    void action_before_reinsert() noexcept
+    {
+        size_ = 0;
+    }
+
+    // node got new sons, sizes of it and its ancestors are recalculated
+    void action_after_link(node_ptr Null) noexcept
+    {
+        for (auto node = this; node != Null; node = node->parent_)
+            node->recalc_size();
+    }
 };
 } // namespace detail
 } // namespace Container
\ No newline at end of file
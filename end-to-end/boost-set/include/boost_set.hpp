@@ -33,6 +33,8 @@ public:
     using base::minimum;
     using base::find;
     using base::insert;
+    using base::erase;
+    using base::merge;
     using base::begin;
     using base::end;
     using base::cbegin;
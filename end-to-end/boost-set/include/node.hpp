@@ -64,6 +64,14 @@ struct RBNode
     void action_after_right_rotate(node_ptr Null) noexcept {}
 
     void action_before_insert(node_ptr Null) noexcept {}
+
+    void action_before_erase(node_ptr Null) noexcept {}
+
+    void action_after_replace(node_ptr other) noexcept {}
+
+    void action_before_reinsert() noexcept {}
+
+    void action_after_link(node_ptr Null) noexcept {}
 };
 
 // for sorted search tree
@@ -1,7 +1,10 @@
 #pragma once
+#include <algorithm>
+#include <bit>
 #include <functional>
 #include <fstream>
 #include <string>
+#include <tuple>
 #include "node.hpp"
 #include "search_tree_iterator.hpp"
 
@@ -19,7 +22,7 @@ protected:
     using const_node_ptr = const Node*;
     using key_type       = KeyT;
     using size_type      = typename std::size_t;
-    using ConstIterator = SearchTreeIterator<key_type, Cmp, node_type>;
+    using ConstIterator = RBSearchTreeIterator<key_type, Cmp, node_type>;
     using Iterator = ConstIterator;
 
 private:
@@ -365,7 +368,8 @@ private:
             Null_->left_ = node;
     }
 
-    void rb_insert_fix(node_ptr node)
+    // returns true if root was recolored, so black height of tree grew
+    bool rb_insert_fix(node_ptr node)
     {
         // fix min and max pointers
         insert_fix_min_max(node);
@@ -477,7 +481,9 @@ private:
                 }
             }
         // fix invariont that is "root is black"
+        bool grown = (root_->color_ == Colors::Red);
         root_->color_ = Colors::Black;
+        return grown;
     }
 //----------------------------------------=| Insert end |=----------------------------------------------
 
@@ -516,6 +522,8 @@ private:
         \*/
         if (z->left_ == Null_)
         {
+            // z leaves tree, update its ancestors
+            z->action_before_erase(Null_);
             // save root os subtree that will be replace
             x = z->right_;
             // replace right subtree of z with z
@@ -534,6 +542,7 @@ private:
         \*/
         else if (z->right_ == Null_)
         {
+            z->action_before_erase(Null_);
             x = z->left_;
             transplant(z, z->left_);
         }
@@ -557,6 +566,8 @@ private:
             // find y in right subtree of x
             // y most left of z->right than y->left_ == Null_
             y = detail::find_min(z->right_, Null_);
+            // y leaves its place (z is one of its ancestors)
+            y->action_before_erase(Null_);
             // save original color of y node
             // (look at the end of method to see cause)
             y_original_color = y->color_;
@@ -585,6 +596,7 @@ private:
             y->left_->parent_ = y;
             // to save invariant everywhere except in subtree with root x
             y->color_ = z->color_;
+            y->action_after_replace(z);
         }
 
         // in first two cases ("if" and "else if")
@@ -698,6 +710,295 @@ protected:
     }
 //----------------------------------------=| Erase end |=-----------------------------------------------
 
+//----------------------------------------=| Merge start |=---------------------------------------------
+private:
+    // subtree, parent of its root is Null_, and number of black nodes on path from root to leaf
+    struct Subtree
+    {
+        node_ptr  root_;
+        size_type height_;
+    };
+
+    // sorted list of nodes linked by right_
+    struct NodeList
+    {
+        node_ptr  head = nullptr, tail = nullptr;
+        size_type size = 0;
+
+        void push_back(node_ptr node) noexcept
+        {
+            if (tail)
+                tail->right_ = node;
+            else
+                head = node;
+            tail = node;
+            size++;
+        }
+    };
+
+    // forget nodes, returns old root
+    node_ptr release() noexcept
+    {
+        auto root = root_;
+        root_ = Null_;
+        size_ = 0;
+        Null_->left_ = Null_->right_ = Null_->parent_ = Null_;
+        return root;
+    }
+
+    // replaces sentinel of other tree in links of subtree with Null_
+    void adopt_links(node_ptr root, node_ptr other_null) noexcept
+    {
+        root->parent_ = Null_;
+        // iterative traversal, previous node tells where we came from
+        for (node_ptr node = root, prev = Null_, next = Null_; node != Null_; prev = node, node = next)
+            if (prev == node->parent_)
+            {
+                if (node->left_ == other_null)
+                    node->left_ = Null_;
+                if (node->right_ == other_null)
+                    node->right_ = Null_;
+                next = (node->left_ != Null_) ? node->left_ : (node->right_ != Null_) ? node->right_ : node->parent_;
+            }
+            else if (prev == node->left_ && node->right_ != Null_)
+                next = node->right_;
+            else
+                next = node->parent_;
+    }
+
+    // number of black nodes on path from root to leaf
+    size_type black_height(node_ptr root) const noexcept
+    {
+        size_type height = 0;
+        for (; root != Null_; root = root->left_)
+            if (root->color_ == Colors::Black)
+                height++;
+        return height;
+    }
+
+    // Links node red in place of black node with same black height on spine of higher tree, left tree is
+    // root_ (all keys are less). Returns true if black height of joined tree grew
+    bool join_right(node_ptr node, node_ptr right, size_type left_height, size_type right_height) noexcept
+    {
+        node->color_ = Colors::Red;
+        node->action_before_reinsert();
+
+        if (left_height >= right_height)
+        {
+            auto spine = root_;
+            for (auto height = left_height; spine->color_ == Colors::Red || height != right_height; spine = spine->right_)
+                if (spine->color_ == Colors::Black)
+                    height--;
+            node->parent_ = spine->parent_;
+            if (spine == root_)
+                root_ = node;
+            else
+                spine->parent_->right_ = node;
+            node->left_  = spine;
+            node->right_ = right;
+        }
+        else
+        {
+            auto spine = right;
+            for (auto height = right_height; spine->color_ == Colors::Red || height != left_height; spine = spine->left_)
+                if (spine->color_ == Colors::Black)
+                    height--;
+            node->parent_ = spine->parent_;
+            if (spine == right)
+                right = node;
+            else
+                spine->parent_->left_ = node;
+            node->left_  = root_;
+            node->right_ = spine;
+            root_ = right;
+        }
+        node->left_->parent_  = node;
+        node->right_->parent_ = node;
+        node->action_after_link(Null_);
+        return rb_insert_fix(node);
+    }
+
+    // Joins subtrees with node between them (keys of left are less than key of node, keys of right are
+    // greater) in O(difference of black heights + 1). Rotations work on root_, so it is restored after join
+    Subtree join(Subtree left, node_ptr node, Subtree right) noexcept
+    {
+        // red root is blackened, all paths of its subtree get one more black node
+        for (auto subtree: {&left, &right})
+            if (subtree->root_->color_ == Colors::Red)
+            {
+                subtree->root_->color_ = Colors::Black;
+                subtree->height_++;
+            }
+
+        if (left.root_ == Null_ && right.root_ == Null_)
+        {
+            node->color_  = Colors::Black;
+            node->parent_ = node->left_ = node->right_ = Null_;
+            node->action_before_reinsert();
+            node->action_after_link(Null_);
+            return Subtree{node, 1};
+        }
+
+        auto root = root_;
+        bool grown = false;
+        if (left.root_ == Null_ || right.root_ == Null_)
+        {
+            // node is new minimum or maximum of other subtree
+            root_ = (left.root_ == Null_) ? right.root_ : left.root_;
+            auto parent = (left.root_ == Null_) ? detail::find_min(root_, Null_) : detail::find_max(root_, Null_);
+            if (left.root_ == Null_)
+                parent->left_ = node;
+            else
+                parent->right_ = node;
+            node->color_  = Colors::Red;
+            node->parent_ = parent;
+            node->left_   = Null_;
+            node->right_  = Null_;
+            node->action_before_reinsert();
+            node->action_before_insert(Null_);
+            grown = rb_insert_fix(node);
+        }
+        else
+        {
+            root_ = left.root_;
+            grown = join_right(node, right.root_, left.height_, right.height_);
+        }
+
+        Subtree joined {root_, std::max(left.height_, right.height_) + grown};
+        root_ = root;
+        return joined;
+    }
+
+    // sons of root become subtrees, root is detached
+    std::tuple<Subtree, node_ptr, Subtree> expose(Subtree tree) noexcept
+    {
+        auto root = tree.root_;
+        auto height = tree.height_ - (root->color_ == Colors::Black);
+        if (root->left_ != Null_)
+            root->left_->parent_ = Null_;
+        if (root->right_ != Null_)
+            root->right_->parent_ = Null_;
+        return {Subtree{root->left_, height}, root, Subtree{root->right_, height}};
+    }
+
+    // Subtrees of keys less and greater than key and detached node with key (Null_ if there is no key)
+    // in O(log n): heights of joined subtrees telescope along search path
+    std::tuple<Subtree, node_ptr, Subtree> split(Subtree tree, const key_type& key) noexcept
+    {
+        if (tree.root_ == Null_)
+            return {tree, Null_, tree};
+
+        auto [left, node, right] = expose(tree);
+        if (key_less(key, node->key_))
+        {
+            auto [less, equal, greater] = split(left, key);
+            return {less, equal, join(greater, node, right)};
+        }
+        if (key_less(node->key_, key))
+        {
+            auto [less, equal, greater] = split(right, key);
+            return {join(left, node, less), equal, greater};
+        }
+        return {left, node, right};
+    }
+
+    // Union of subtree of this tree and subtree of other tree by split/join in O(m log(n/m + 1)), nodes of
+    // other tree with keys found in this one are collected in order
+    Subtree unite(Subtree tree, Subtree other, NodeList& duplicates) noexcept
+    {
+        if (other.root_ == Null_)
+            return tree;
+        if (tree.root_ == Null_)
+            return other;
+
+        auto [other_left, node, other_right] = expose(other);
+        auto [less, equal, greater] = split(tree, node->key_);
+        auto left = unite(less, other_left, duplicates);
+        if (equal != Null_)
+            duplicates.push_back(node);
+        auto right = unite(greater, other_right, duplicates);
+        return join(left, (equal != Null_) ? equal : node, right);
+    }
+
+    // Balanced tree of first count nodes of sorted list, list is advanced. Only nodes of lowest level (it
+    // may be incomplete) are red, so all paths from root to leaves have the same number of black nodes
+    node_ptr link_list(node_ptr& list, size_type count, size_type depth, size_type red_depth) noexcept
+    {
+        if (!count)
+            return Null_;
+        auto left   = link_list(list, count / 2, depth + 1, red_depth);
+        auto middle = list;
+        list = list->right_;
+        auto right  = link_list(list, count - count / 2 - 1, depth + 1, red_depth);
+
+        middle->color_  = (depth != 0 && depth == red_depth) ? Colors::Red : Colors::Black;
+        middle->parent_ = Null_;
+        middle->left_   = left;
+        middle->right_  = right;
+        if (left != Null_)
+            left->parent_ = middle;
+        if (right != Null_)
+            right->parent_ = middle;
+        middle->action_after_link(Null_);
+        return middle;
+    }
+
+    // links nodes of sorted list in this empty tree
+    void adopt_list(const NodeList& list) noexcept
+    {
+        if (!list.size)
+            return;
+        auto head = list.head;
+        root_ = link_list(head, list.size, 0, std::bit_width(list.size) - 1);
+        size_ = list.size;
+        Null_->left_  = detail::find_min(root_, Null_);
+        Null_->right_ = detail::find_max(root_, Null_);
+    }
+
+protected:
+    // Moves nodes of other with keys not found in this tree without allocations, like std::set::merge.
+    // Every tree has own sentinel, so stolen nodes are relinked on Null_ of this tree in O(m) first.
+    // Trees with disjoint ranges are joined through extreme node of this tree in O(log n), otherwise
+    // nodes are moved by split/join union in O(m log(n/m + 1)) and nodes with duplicate keys are left in other
+    void merge(RBSearchTree& other)
+    {
+        if (this == &other || other.empty())
+            return;
+        if (empty())
+        {
+            swap(other);
+            return;
+        }
+
+        auto other_null = other.Null_;
+        bool after  = key_less(maximum(), other.minimum());
+        bool before = key_less(other.maximum(), minimum());
+        auto other_size = other.size_;
+        auto stolen = other.release();
+        adopt_links(stolen, other_null);
+        Subtree stolen_tree {stolen, black_height(stolen)};
+
+        if (after || before)
+        {
+            // extreme node of this tree joins two trees
+            auto node = after ? Null_->right_ : Null_->left_;
+            erase_from_tree(node);
+            Subtree tree {root_, black_height(root_)};
+            root_ = (after ? join(tree, node, stolen_tree) : join(stolen_tree, node, tree)).root_;
+            size_ += other_size + 1;
+        }
+        else
+        {
+            NodeList duplicates {};
+            root_ = unite(Subtree{root_, black_height(root_)}, stolen_tree, duplicates).root_;
+            size_ += other_size - duplicates.size;
+            other.adopt_list(duplicates);
+        }
+        Null_->left_  = detail::find_min(root_, Null_);
+        Null_->right_ = detail::find_max(root_, Null_);
+    }
+//----------------------------------------=| Merge end |=-----------------------------------------------
+
 //----------------------------------------=| Bounds start |=--------------------------------------------
 private:
     node_ptr lower_bound_ptr(const key_type& key) const
@@ -10,7 +10,7 @@ template<typename KeyT, class Cmp, typename Node>
 class RBSearchTree;
 
 template<typename KeyT, class Cmp,  typename Node>
-class SearchTreeIterator
+class RBSearchTreeIterator
 {
 public:
     using iterator_category = typename std::bidirectional_iterator_tag;
@@ -25,7 +25,7 @@ private:
     const_node_ptr Null_;
 
 public:
-    SearchTreeIterator(node_ptr node = nullptr, const_node_ptr Null = nullptr) noexcept
+    RBSearchTreeIterator(node_ptr node = nullptr, const_node_ptr Null = nullptr) noexcept
     :node_ {node}, Null_ {Null}
     {}
 
@@ -39,7 +39,7 @@ public:
         return std::addressof(node_->key_);
     }
 
-    SearchTreeIterator& operator++() noexcept
+    RBSearchTreeIterator& operator++() noexcept
     {
         if (node_->right_ != Null_)
             node_ = detail::find_min(node_->right_, Null_);
@@ -57,14 +57,14 @@ public:
         return *this;
     }
 
-    SearchTreeIterator operator++(int) noexcept
+    RBSearchTreeIterator operator++(int) noexcept
     {
         auto cpy {*this};
         ++(*this);
         return cpy;
     }
 
-    SearchTreeIterator& operator--() noexcept
+    RBSearchTreeIterator& operator--() noexcept
     {
         if (node_ == Null_)
             node_ = Null_->right_;
@@ -84,14 +84,14 @@ public:
         return *this;
     }
 
-    SearchTreeIterator operator--(int) noexcept
+    RBSearchTreeIterator operator--(int) noexcept
     {
         auto cpy {*this};
         --(*this);
         return cpy;
     }
 
-    bool operator==(const SearchTreeIterator& rhs) const noexcept
+    bool operator==(const RBSearchTreeIterator& rhs) const noexcept
     {
         return node_ == rhs.node_;
     }
@@ -101,6 +101,6 @@ protected:
     
 public:
     friend class RBSearchTree<KeyT, Cmp, Node>;
-}; // class SearchTreeIterator
+}; // class RBSearchTreeIterator
 } // namespace detail
 } // namespace Container
\ No newline at end of file
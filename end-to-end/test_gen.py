@@ -1,18 +1,33 @@
 #!/usr/bin/env python3
-import random, sys, math
+import random, sys, math, struct
 
 # number of keys           - 1 arg
 # number of requests       - 2 arg
 # file name                - 3 arg
 # [opt] mode (--normal,
-# --triangular, --uniform) - 4 arg
+# --triangular, --uniform) - next args
+# [opt] --binary, --int64  - next args
+# [opt] --mixed[=I:E:F:R:Q] - operations instead of requests: insert, erase,
+#                             find, rank, range count in given ratios (1:1:2:2:4)
 
 num_of_keys = int(sys.argv[1])
 num_of_reqs = int(sys.argv[2])
 file_name   = sys.argv[3]
+options = sys.argv[4:]
 mode = ""
-if len(sys.argv) == 5:
-    mode = sys.argv[4]
+for opt in options:
+    if opt in ("--normal", "--triangular", "--uniform"):
+        mode = opt
+binary = "--binary" in options
+int64  = "--int64" in options
+mixed  = None
+for opt in options:
+    if opt == "--mixed":
+        mixed = [1, 1, 2, 2, 4]
+    elif opt.startswith("--mixed="):
+        mixed = [int(ratio) for ratio in opt[len("--mixed="):].split(':')]
+        if len(mixed) != 5 or sum(mixed) == 0:
+            sys.exit("--mixed needs five ratios: insert:erase:find:rank:range")
 
 def generate_keys():
     keys_set = set()
@@ -61,8 +76,44 @@ def generate_normal_reqs(min, max):
         reqs.append(second)
     return reqs
 
+# Operations of task/workload.hpp: code, key, second key (right bound of range, else 0).
+# Erased keys are mostly present ones, keys of other operations are spread over range of keys
+def generate_operations(keys):
+    ops = []
+    present = list(keys)
+    index = {key: i for i, key in enumerate(present)}
+    high = 4*num_of_keys
+    dist = max(1, int(high / 10))
+
+    # last key takes place of removed one, so removal is O(1)
+    def remove(key):
+        i = index.pop(key)
+        last = present.pop()
+        if last != key:
+            present[i] = last
+            index[last] = i
+
+    for _ in range(0, num_of_reqs):
+        code = random.choices(range(5), weights=mixed)[0]
+        key = random.randint(0, high)
+        second = 0
+        if code == 0 and key not in index:
+            index[key] = len(present)
+            present.append(key)
+        elif code == 1:
+            if present and random.random() < 0.8:
+                key = random.choice(present)
+            if key in index:
+                remove(key)
+        elif code == 4:
+            second = random.randint(key, key + dist)
+        ops += [code, key, second]
+    return ops
+
 def print_task(keys, reqs):
     file = open(file_name, 'w')
+    if mixed:
+        file.write('mixed\n')
     file.write(str(num_of_keys) + ' ')
     for i in keys:
         file.write(str(i) + ' ')
@@ -72,15 +123,31 @@ def print_task(keys, reqs):
     file.write('\n')
     file.close()
 
+# header (magic, key size, type, reserved, number of keys, number of requests),
+# then packed little-endian keys and bounds (operations), see task/workload.hpp
+def print_binary_task(keys, reqs):
+    key_size = 8 if int64 else 4
+    fmt = '<%d' + ('q' if int64 else 'i')
+    file = open(file_name, 'wb')
+    file.write(struct.pack('<4sBBHQQ', b'SPTW', key_size, 1 if mixed else 0, 0, num_of_keys, num_of_reqs))
+    file.write(struct.pack(fmt % len(keys), *keys))
+    file.write(struct.pack(fmt % len(reqs), *reqs))
+    file.close()
+
 def main():
     keys = generate_keys()
-    if mode == "--triangular":
+    if mixed:
+        reqs = generate_operations(keys)
+    elif mode == "--triangular":
         reqs = generate_triangular_reqs(min(keys), max(keys))
     elif mode == "--normal":
         reqs = generate_normal_reqs(min(keys), max(keys))
     else:
         reqs = generate_uniform_reqs(min(keys), max(keys))
-    print_task(keys, reqs)
+    if binary:
+        print_binary_task(keys, reqs)
+    else:
+        print_task(keys, reqs)
 
 main()
 
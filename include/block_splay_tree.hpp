@@ -0,0 +1,430 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "tree_stats.hpp"
+
+namespace Container
+{
+
+namespace detail
+{
+// Node of block tree: sorted keys of range between keys of left and right subtrees.
+// Unused keys are value-initialized, so block is searched by loop of fixed length
+template<typename KeyT, std::size_t Capacity>
+struct Block final
+{
+    using key_type = KeyT;
+
+    Block* parent_ = nullptr;
+    Block* left_   = nullptr;
+    Block* right_  = nullptr;
+    std::size_t size_ = 0;   // keys in subtree
+    std::size_t count_ = 0;  // keys in block
+    std::array<key_type, Capacity> keys_ {};
+
+    const key_type& front() const noexcept {return keys_[0];}
+    const key_type& back()  const noexcept {return keys_[count_ - 1];}
+
+    void calc_size() noexcept
+    {
+        size_ = count_;
+        if (left_)
+            size_ += left_->size_;
+        if (right_)
+            size_ += right_->size_;
+    }
+};
+} // namespace detail
+
+// Splay tree of blocks of keys. Block holds up to two cache lines of keys, so tree of int keys is
+// about 16-32 times smaller in nodes than SplayTree and every level of descent costs one block,
+// searched by comparisons without branches. Splaying moves whole blocks, sizes of subtrees are
+// counted in keys for ranks. Full block is split in halves, block that got less than quarter full
+// is merged into its successor when they fit in one block
+template<typename KeyT, class Cmp = std::less<KeyT>>
+class BlockSplayTree final
+{
+public:
+    using key_type  = KeyT;
+    using size_type = std::size_t;
+
+    static constexpr size_type block_capacity = std::max<size_type>(4, 128 / sizeof(key_type));
+
+private:
+    using block_type = detail::Block<key_type, block_capacity>;
+    using block_ptr  = block_type*;
+
+    mutable block_ptr root_ = nullptr;
+    size_type blocks_ = 0;
+    Cmp cmp {};
+
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    BlockSplayTree() = default;
+
+    template<std::input_iterator InpIt>
+    BlockSplayTree(InpIt first, InpIt last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    BlockSplayTree(std::initializer_list<key_type> initlist)
+    :BlockSplayTree(initlist.begin(), initlist.end())
+    {}
+
+    BlockSplayTree(const BlockSplayTree&) = delete;
+    BlockSplayTree& operator=(const BlockSplayTree&) = delete;
+
+    BlockSplayTree(BlockSplayTree&& other) noexcept
+    {
+        swap(other);
+    }
+
+    BlockSplayTree& operator=(BlockSplayTree&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(BlockSplayTree& other) noexcept
+    {
+        std::swap(root_, other.root_);
+        std::swap(blocks_, other.blocks_);
+        std::swap(cmp, other.cmp);
+    }
+
+    ~BlockSplayTree()
+    {
+        // rotations make left subtree empty, so all blocks are freed without stack
+        while (root_)
+        {
+            if (auto left = root_->left_)
+            {
+                root_->left_ = left->right_;
+                left->right_ = root_;
+                root_ = left;
+            }
+            else
+            {
+                auto right = root_->right_;
+                delete root_;
+                root_ = right;
+            }
+        }
+    }
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return root_ ? root_->size_ : 0;}
+
+    bool empty() const noexcept {return (size() == 0);}
+
+    size_type blocks() const noexcept {return blocks_;}
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| Modifiers start |=-----------------------------------------
+    bool insert(const key_type& key)
+    {
+        if (!root_)
+        {
+            root_ = new block_type{};
+            blocks_++;
+        }
+        auto block = descend(key);
+        splay(block);
+
+        auto position = lower_bound_in(block, key);
+        if (position < block->count_ && !cmp(key, block->keys_[position]))
+            return false;
+
+        if (block->count_ == block_capacity)
+        {
+            // upper half becomes successor of block
+            auto upper = new block_type{};
+            blocks_++;
+            auto half = block_capacity / 2;
+            std::move(block->keys_.begin() + half, block->keys_.end(), upper->keys_.begin());
+            upper->count_ = block_capacity - half;
+            block->count_ = half;
+
+            upper->right_ = block->right_;
+            if (upper->right_)
+                upper->right_->parent_ = upper;
+            upper->parent_ = block;
+            block->right_ = upper;
+            upper->calc_size();
+
+            if (position > half)
+            {
+                insert_at(upper, position - half, key);
+                upper->size_++;
+                block->calc_size();
+                return true;
+            }
+        }
+        insert_at(block, position, key);
+        block->calc_size();
+        return true;
+    }
+
+    bool erase(const key_type& key)
+    {
+        if (!root_)
+            return false;
+        auto block = descend(key);
+        splay(block);
+
+        auto position = lower_bound_in(block, key);
+        if (position == block->count_ || cmp(key, block->keys_[position]))
+            return false;
+        std::move(block->keys_.begin() + position + 1, block->keys_.begin() + block->count_,
+                  block->keys_.begin() + position);
+        block->count_--;
+        block->size_--;
+
+        if (block->count_ == 0)
+            erase_root_block();
+        else if (block->count_ < block_capacity / 4)
+            merge_with_successor(block);
+        return true;
+    }
+//----------------------------------------=| Modifiers end |=-------------------------------------------
+
+//----------------------------------------=| Lookup start |=--------------------------------------------
+    bool contains(const key_type& key) const
+    {
+        if (!root_)
+            return false;
+        auto block = descend(key);
+        splay(block);
+        auto position = lower_bound_in(block, key);
+        return position < block->count_ && !cmp(key, block->keys_[position]);
+    }
+
+    size_type number_less_than(const key_type& key) const
+    {
+        return rank(key, [this](const key_type& other, const key_type& bound) {return cmp(other, bound);});
+    }
+
+    size_type number_not_greater_than(const key_type& key) const
+    {
+        return rank(key, [this](const key_type& other, const key_type& bound) {return !cmp(bound, other);});
+    }
+
+    // number of keys in [first, last]
+    size_type count_in_range(const key_type& first, const key_type& last) const
+    {
+        if (cmp(last, first))
+            return 0;
+        return number_not_greater_than(last) - number_less_than(first);
+    }
+//----------------------------------------=| Lookup end |=----------------------------------------------
+
+//----------------------------------------=| Shape start |=---------------------------------------------
+    // shape of tree of blocks, size is number of blocks
+    TreeShape shape() const
+    {
+        TreeShape shape {};
+        std::vector<std::pair<block_ptr, size_type>> stack {};
+        if (root_)
+            stack.emplace_back(root_, 0);
+        double depth_sum = 0;
+        while (!stack.empty())
+        {
+            auto [block, depth] = stack.back();
+            stack.pop_back();
+            if (shape.depth_histogram.size() <= depth)
+                shape.depth_histogram.resize(depth + 1);
+            shape.depth_histogram[depth]++;
+            depth_sum += depth;
+            shape.size++;
+            for (auto child: {block->left_, block->right_})
+                if (child)
+                    stack.emplace_back(child, depth + 1);
+        }
+        shape.height = shape.depth_histogram.size();
+        shape.average_depth = shape.size ? depth_sum / shape.size : 0;
+        return shape;
+    }
+//----------------------------------------=| Shape end |=-----------------------------------------------
+
+//----------------------------------------=| Blocks start |=--------------------------------------------
+private:
+    // Number of keys of block for which before(key) is true, before is true for prefix of keys.
+    // Loop of fixed length without branches is vectorized for arithmetic keys
+    template<typename Before>
+    static size_type count_in(const block_type* block, Before before) noexcept
+    {
+        auto& keys = block->keys_;
+        auto used = static_cast<std::uint32_t>(block->count_);
+        std::uint32_t count = 0;
+        for (std::uint32_t i = 0; i < block_capacity; i++)
+            count += static_cast<std::uint32_t>((i < used) & before(keys[i]));
+        return count;
+    }
+
+    size_type lower_bound_in(const block_type* block, const key_type& key) const noexcept
+    {
+        return count_in(block, [this, &key](const key_type& other) {return cmp(other, key);});
+    }
+
+    static void insert_at(block_ptr block, size_type position, const key_type& key)
+    {
+        std::move_backward(block->keys_.begin() + position, block->keys_.begin() + block->count_,
+                           block->keys_.begin() + block->count_ + 1);
+        block->keys_[position] = key;
+        block->count_++;
+    }
+
+    // block whose range contains key or where descent for key ends
+    block_ptr descend(const key_type& key) const noexcept
+    {
+        auto block = root_;
+        while (true)
+        {
+            block_ptr next = nullptr;
+            if (block->count_ && cmp(key, block->front()))
+                next = block->left_;
+            else if (block->count_ && cmp(block->back(), key))
+                next = block->right_;
+            if (!next)
+                return block;
+            block = next;
+        }
+    }
+
+    template<typename Before>
+    size_type rank(const key_type& key, Before before) const
+    {
+        if (!root_)
+            return 0;
+        size_type number = 0;
+        auto block = root_;
+        while (true)
+        {
+            block_ptr next = nullptr;
+            if (cmp(key, block->front()))
+                next = block->left_;
+            else if (cmp(block->back(), key))
+            {
+                next = block->right_;
+                if (next)
+                    number += block->size_ - next->size_;
+            }
+            if (!next)
+                break;
+            block = next;
+        }
+        if (block->left_)
+            number += block->left_->size_;
+        number += count_in(block, [&](const key_type& other) {return before(other, key);});
+        splay(block);
+        return number;
+    }
+
+    // root block is empty: its subtrees are joined under max block of left one
+    void erase_root_block() noexcept
+    {
+        auto left = root_->left_, right = root_->right_;
+        delete root_;
+        blocks_--;
+        root_ = left;
+        if (!left)
+        {
+            root_ = right;
+            if (right)
+                right->parent_ = nullptr;
+            return;
+        }
+
+        left->parent_ = nullptr;
+        auto max = left;
+        while (max->right_)
+            max = max->right_;
+        splay(max);
+        max->right_ = right;
+        if (right)
+            right->parent_ = max;
+        max->calc_size();
+    }
+
+    // Splaying successor of root makes root its left son without right subtree
+    void merge_with_successor(block_ptr block) noexcept
+    {
+        auto successor = block->right_;
+        if (!successor)
+            return;
+        while (successor->left_)
+            successor = successor->left_;
+        if (block->count_ + successor->count_ > block_capacity)
+            return;
+
+        splay(successor);
+        if (successor->left_ != block || block->right_)
+            return;
+        std::move_backward(successor->keys_.begin(), successor->keys_.begin() + successor->count_,
+                           successor->keys_.begin() + successor->count_ + block->count_);
+        std::move(block->keys_.begin(), block->keys_.begin() + block->count_, successor->keys_.begin());
+        successor->count_ += block->count_;
+
+        successor->left_ = block->left_;
+        if (block->left_)
+            block->left_->parent_ = successor;
+        delete block;
+        blocks_--;
+    }
+//----------------------------------------=| Blocks end |=----------------------------------------------
+
+//----------------------------------------=| Splay start |=---------------------------------------------
+    void rotate(block_ptr block) const noexcept
+    {
+        auto parent = block->parent_, grand = parent->parent_;
+        if (block == parent->left_)
+        {
+            parent->left_ = block->right_;
+            if (block->right_)
+                block->right_->parent_ = parent;
+            block->right_ = parent;
+        }
+        else
+        {
+            parent->right_ = block->left_;
+            if (block->left_)
+                block->left_->parent_ = parent;
+            block->left_ = parent;
+        }
+        parent->parent_ = block;
+        block->parent_ = grand;
+        if (grand)
+            (grand->left_ == parent ? grand->left_ : grand->right_) = block;
+        parent->calc_size();
+        block->calc_size();
+    }
+
+    // block becomes root of tree (or of detached subtree, if its root has no parent)
+    void splay(block_ptr block) const noexcept
+    {
+        while (auto parent = block->parent_)
+        {
+            if (auto grand = parent->parent_)
+            {
+                if ((block == parent->left_) == (parent == grand->left_))
+                    rotate(parent);
+                else
+                    rotate(block);
+            }
+            rotate(block);
+        }
+        root_ = block;
+    }
+//----------------------------------------=| Splay end |=-----------------------------------------------
+}; // class BlockSplayTree
+} // namespace Container
@@ -0,0 +1,201 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "splay_tree.hpp"
+
+namespace Container
+{
+
+// SplayTree shared by threads with flat combining. Thread publishes its operation in a free slot,
+// then the one thread that holds the lock (combiner) applies all published operations sorted by key,
+// so neighbouring keys share splay paths, and posts results back to slots. Other threads wait
+// on their slots instead of handing the lock over to each other
+template<typename KeyT, class Cmp = std::less<KeyT>>
+class CombiningSplayTree final
+{
+public:
+    using key_type  = KeyT;
+    using size_type = std::size_t;
+    using tree_type = SplayTree<KeyT, Cmp>;
+
+private:
+    enum class Operation {Insert, Erase, Contains};
+    enum State {Free, Claimed, Pending, Done};
+
+    // own cache line, waiting threads spin on their states only
+    struct alignas(64) Slot
+    {
+        std::atomic<int> state_ {Free};
+        Operation operation_ {};
+        const key_type* key_ = nullptr;  // owner waits until operation is done
+        bool result_ = false;
+        std::exception_ptr error_ {};
+    };
+
+    size_type capacity_;
+    std::unique_ptr<Slot[]> slots_;
+
+    std::mutex combiner_mutex_;
+    // under combiner lock
+    tree_type tree_ {};
+    std::vector<Slot*> batch_ {};
+    size_type batches_ = 0, combined_ = 0;
+
+    std::atomic<size_type> size_ {0};
+    Cmp cmp {};
+
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    // more slots than threads, so threads rarely wait for free one
+    explicit CombiningSplayTree(size_type slots = 2 * std::max(1u, std::thread::hardware_concurrency()))
+    :capacity_ {slots}
+    {
+        if (capacity_ == 0)
+            throw std::invalid_argument{"CombiningSplayTree: need at least one slot"};
+        slots_ = std::make_unique<Slot[]>(capacity_);
+        batch_.reserve(capacity_);
+    }
+
+    CombiningSplayTree(const CombiningSplayTree&) = delete;
+    CombiningSplayTree& operator=(const CombiningSplayTree&) = delete;
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return size_.load();}
+
+    bool empty() const noexcept {return (size() == 0);}
+
+    // average number of operations applied by one combiner pass
+    double average_batch()
+    {
+        std::lock_guard lock {combiner_mutex_};
+        return batches_ ? static_cast<double>(combined_) / batches_ : 0.0;
+    }
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| Operations start |=----------------------------------------
+    bool insert(const key_type& key) {return execute(Operation::Insert, key);}
+
+    bool erase(const key_type& key) {return execute(Operation::Erase, key);}
+
+    bool contains(const key_type& key) {return execute(Operation::Contains, key);}
+
+    // f(tree) under combiner lock, for queries without own operation
+    template<typename F>
+    decltype(auto) locked(F&& f)
+    {
+        std::lock_guard lock {combiner_mutex_};
+        return std::invoke(std::forward<F>(f), std::as_const(tree_));
+    }
+//----------------------------------------=| Operations end |=------------------------------------------
+
+//----------------------------------------=| Combining start |=-----------------------------------------
+private:
+    bool execute(Operation operation, const key_type& key)
+    {
+        auto& slot = claim();
+        slot.operation_ = operation;
+        slot.key_ = &key;
+        slot.state_.store(Pending, std::memory_order_release);
+
+        // either some combiner applies operation or this thread becomes combiner
+        while (slot.state_.load(std::memory_order_acquire) != Done)
+        {
+            if (combiner_mutex_.try_lock())
+            {
+                combine();
+                combiner_mutex_.unlock();
+            }
+            else
+                std::this_thread::yield();
+        }
+
+        auto result = slot.result_;
+        auto error = std::exchange(slot.error_, nullptr);
+        slot.state_.store(Free, std::memory_order_release);
+        if (error)
+            std::rethrow_exception(error);
+        return result;
+    }
+
+    // probing starts from slot of this thread, so threads rarely compete for one slot
+    Slot& claim() noexcept
+    {
+        auto index = std::hash<std::thread::id>{}(std::this_thread::get_id()) % capacity_;
+        while (true)
+        {
+            for (size_type i = 0; i < capacity_; i++)
+            {
+                auto& slot = slots_[(index + i) % capacity_];
+                int state = Free;
+                if (slot.state_.load(std::memory_order_relaxed) == Free &&
+                    slot.state_.compare_exchange_strong(state, Claimed, std::memory_order_acquire))
+                    return slot;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    // under combiner lock
+    void combine()
+    {
+        for (size_type i = 0; i < capacity_; i++)
+            if (slots_[i].state_.load(std::memory_order_acquire) == Pending)
+                batch_.push_back(&slots_[i]);
+        if (batch_.empty())
+            return;
+
+        std::sort(batch_.begin(), batch_.end(), [this](const Slot* lhs, const Slot* rhs)
+                  {return cmp(*lhs->key_, *rhs->key_);});
+        for (auto slot: batch_)
+        {
+            try
+            {
+                slot->result_ = apply(slot->operation_, *slot->key_);
+            }
+            catch (...)
+            {
+                slot->error_ = std::current_exception();
+            }
+            slot->state_.store(Done, std::memory_order_release);
+        }
+        batches_++;
+        combined_ += batch_.size();
+        batch_.clear();
+    }
+
+    bool apply(Operation operation, const key_type& key)
+    {
+        switch (operation)
+        {
+            case Operation::Insert:
+                if (!tree_.insert(key).second)
+                    return false;
+                size_++;
+                return true;
+
+            case Operation::Erase:
+            {
+                auto itr = tree_.find(key);
+                if (itr == tree_.end())
+                    return false;
+                tree_.erase(itr);
+                size_--;
+                return true;
+            }
+
+            default:
+                return tree_.find(key) != tree_.end();
+        }
+    }
+//----------------------------------------=| Combining end |=-------------------------------------------
+}; // class CombiningSplayTree
+} // namespace Container
@@ -0,0 +1,315 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "tree_stats.hpp"
+
+namespace Container
+{
+
+namespace detail
+{
+// one byte lock for nodes, critical sections are few stores long
+class SpinLock final
+{
+    std::atomic<bool> locked_ {false};
+public:
+    bool try_lock() noexcept
+    {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void lock() noexcept
+    {
+        while (!try_lock())
+            std::this_thread::yield();
+    }
+
+    void unlock() noexcept {locked_.store(false, std::memory_order_release);}
+};
+} // namespace detail
+
+// Concurrent self-adjusting set in style of counting-based splay trees (CBTree). Nodes count accesses
+// to themselves and to their subtrees, access rotates node over its parent only when counters show
+// that weighted depth decreases. Lookups take no locks: they are validated by versions of nodes,
+// as in optimistic trees of Bronson et al. Rotations and links of new nodes lock the nodes they change,
+// rotations only try locks and are skipped under contention. Erased keys stay as routing nodes,
+// memory is freed by destructor
+template<typename KeyT, class Cmp = std::less<KeyT>>
+class ConcurrentSplayTree final
+{
+public:
+    using key_type  = KeyT;
+    using size_type = std::size_t;
+
+    // one of this number of accesses of a thread updates counters, it keeps cache lines
+    // of nodes near root from bouncing between cores on every lookup
+    static constexpr unsigned count_period = 8;
+
+private:
+    enum Side {Left = 0, Right = 1};
+
+    struct Node;
+
+    struct Link
+    {
+        std::atomic<Node*> child_[2] {};
+        // accesses to subtrees, counted without synchronization and may lose increments
+        std::atomic<std::uint64_t> weight_[2] {};
+        // odd while rotation moves node down and its range of keys shrinks
+        std::atomic<std::uint64_t> version_ {0};
+        detail::SpinLock lock_ {};
+    };
+
+    struct Node final : Link
+    {
+        const key_type key_;
+        std::atomic<std::uint64_t> hits_ {0};
+        std::atomic<bool> present_ {true};
+
+        explicit Node(const key_type& key): key_ {key} {}
+    };
+
+    // where descent for key ended: node with this key or empty child of parent
+    struct Path
+    {
+        Link* grand_;
+        Side grand_side_;
+        Link* parent_;
+        Side side_;
+        std::uint64_t parent_version_;
+        Node* node_;
+    };
+
+    // root is left child of holder, so root is rotated as any other node
+    mutable Link holder_ {};
+    std::atomic<size_type> size_ {0};
+    Cmp cmp {};
+
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    ConcurrentSplayTree() = default;
+
+    ConcurrentSplayTree(const ConcurrentSplayTree&) = delete;
+    ConcurrentSplayTree& operator=(const ConcurrentSplayTree&) = delete;
+
+    ~ConcurrentSplayTree()
+    {
+        std::vector<Node*> stack {};
+        if (auto root = holder_.child_[Left].load())
+            stack.push_back(root);
+        while (!stack.empty())
+        {
+            auto node = stack.back();
+            stack.pop_back();
+            for (auto& child: node->child_)
+                if (auto next = child.load())
+                    stack.push_back(next);
+            delete node;
+        }
+    }
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return size_.load();}
+
+    bool empty() const noexcept {return (size() == 0);}
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| Modifiers start |=-----------------------------------------
+    bool insert(const key_type& key)
+    {
+        auto count = is_counted();
+        while (true)
+        {
+            auto path = locate(key, count);
+            if (path.node_)
+            {
+                // erased node is revived
+                bool erased = false;
+                if (!path.node_->present_.compare_exchange_strong(erased, true))
+                    return false;
+                size_++;
+                return true;
+            }
+
+            // empty child is linked if parent is not moved down since descent
+            auto parent = path.parent_;
+            std::lock_guard lock {parent->lock_};
+            if (parent->version_.load() != path.parent_version_ || parent->child_[path.side_].load())
+                continue;
+            parent->child_[path.side_].store(new Node{key}, std::memory_order_release);
+            size_++;
+            return true;
+        }
+    }
+
+    bool erase(const key_type& key)
+    {
+        auto path = locate(key, is_counted());
+        bool present = true;
+        if (!path.node_ || !path.node_->present_.compare_exchange_strong(present, false))
+            return false;
+        size_--;
+        return true;
+    }
+//----------------------------------------=| Modifiers end |=-------------------------------------------
+
+//----------------------------------------=| Lookup start |=--------------------------------------------
+    bool contains(const key_type& key) const
+    {
+        auto count = is_counted();
+        auto path = locate(key, count);
+        if (!path.node_)
+            return false;
+        if (count)
+            adjust(path);
+        return path.node_->present_.load();
+    }
+//----------------------------------------=| Lookup end |=----------------------------------------------
+
+//----------------------------------------=| Shape start |=---------------------------------------------
+    // Height and depth histogram of all nodes, erased ones too. Exact only without concurrent updates
+    TreeShape shape() const
+    {
+        TreeShape shape {};
+        // pre-order, parents go before children
+        std::vector<std::pair<const Node*, size_type>> nodes {};
+        if (auto root = holder_.child_[Left].load())
+            nodes.emplace_back(root, 0);
+        for (size_type i = 0; i < nodes.size(); i++)
+            for (auto& child: nodes[i].first->child_)
+                if (auto next = child.load())
+                    nodes.emplace_back(next, nodes[i].second + 1);
+
+        shape.size = nodes.size();
+        if (nodes.empty())
+            return shape;
+        double depth_sum = 0;
+        for (auto [node, depth]: nodes)
+        {
+            if (shape.depth_histogram.size() <= depth)
+                shape.depth_histogram.resize(depth + 1);
+            shape.depth_histogram[depth]++;
+            depth_sum += depth;
+        }
+        shape.height = shape.depth_histogram.size();
+        shape.average_depth = depth_sum / shape.size;
+        return shape;
+    }
+//----------------------------------------=| Shape end |=-----------------------------------------------
+
+//----------------------------------------=| Descent start |=-------------------------------------------
+private:
+    static bool is_counted() noexcept
+    {
+        thread_local unsigned tick = 0;
+        return (tick++ % count_period) == 0;
+    }
+
+    static void increment(std::atomic<std::uint64_t>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Descent without locks. Child is entered only if link to it was valid when version of child was read,
+    // node that was moved down since its version was read makes descent restart from root
+    Path locate(const key_type& key, bool count) const
+    {
+    restart:
+        Path path {nullptr, Left, &holder_, Left, holder_.version_.load(std::memory_order_acquire), nullptr};
+        while (true)
+        {
+            auto parent = path.parent_;
+            auto child = parent->child_[path.side_].load(std::memory_order_acquire);
+            if (parent->version_.load(std::memory_order_acquire) != path.parent_version_)
+                goto restart;
+            if (!child)
+                return path;
+
+            auto child_version = child->version_.load(std::memory_order_acquire);
+            if (child_version & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            if (parent->child_[path.side_].load(std::memory_order_acquire) != child)
+                continue;
+            if (parent->version_.load(std::memory_order_acquire) != path.parent_version_)
+                goto restart;
+
+            if (count)
+                increment(parent->weight_[path.side_]);
+            if (!cmp(key, child->key_) && !cmp(child->key_, key))
+            {
+                if (count)
+                    increment(child->hits_);
+                path.node_ = child;
+                return path;
+            }
+            path.grand_ = parent;
+            path.grand_side_ = path.side_;
+            path.parent_ = child;
+            path.side_ = cmp(key, child->key_) ? Left : Right;
+            path.parent_version_ = child_version;
+        }
+    }
+//----------------------------------------=| Descent end |=---------------------------------------------
+
+//----------------------------------------=| Rotations start |=-----------------------------------------
+    // Node goes up with subtree on its side, parent goes down with subtree on other side.
+    // Rotation is done when it decreases depth of more counted accesses than it increases
+    void adjust(const Path& path) const
+    {
+        if (path.parent_ == &holder_)
+            return;
+        auto node = path.node_;
+        auto parent = static_cast<Node*>(path.parent_);
+        auto side = path.side_, other = static_cast<Side>(1 - side);
+
+        auto up   = node->hits_.load(std::memory_order_relaxed) + node->weight_[side].load(std::memory_order_relaxed);
+        auto down = parent->hits_.load(std::memory_order_relaxed) + parent->weight_[other].load(std::memory_order_relaxed);
+        if (up > down)
+            rotate(path.grand_, path.grand_side_, parent, node, side);
+    }
+
+    // lookups don't wait: rotation is skipped if any of three nodes is locked
+    void rotate(Link* grand, Side grand_side, Node* parent, Node* node, Side side) const
+    {
+        if (!grand->lock_.try_lock())
+            return;
+        if (!parent->lock_.try_lock())
+        {
+            grand->lock_.unlock();
+            return;
+        }
+        bool linked = grand->child_[grand_side].load() == parent && parent->child_[side].load() == node;
+        if (linked && node->lock_.try_lock())
+        {
+            auto other = static_cast<Side>(1 - side);
+            auto inner = node->child_[other].load();
+
+            // descents through parent restart while it is moved down
+            auto version = parent->version_.load();
+            parent->version_.store(version + 1);
+            parent->child_[side].store(inner, std::memory_order_release);
+            node->child_[other].store(parent, std::memory_order_release);
+            grand->child_[grand_side].store(node, std::memory_order_release);
+            parent->version_.store(version + 2, std::memory_order_release);
+
+            // inner subtree moved from node to parent, parent became part of subtree of node
+            parent->weight_[side].store(node->weight_[other].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            node->weight_[other].store(parent->hits_.load(std::memory_order_relaxed) +
+                                       parent->weight_[Left].load(std::memory_order_relaxed) +
+                                       parent->weight_[Right].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            node->lock_.unlock();
+        }
+        parent->lock_.unlock();
+        grand->lock_.unlock();
+    }
+//----------------------------------------=| Rotations end |=-------------------------------------------
+}; // class ConcurrentSplayTree
+} // namespace Container
@@ -0,0 +1,246 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace Container
+{
+
+// keys that are encoded by their distances from min key in natural order
+template<typename KeyT, class Cmp>
+concept elias_fano_encodable = std::integral<KeyT> && (std::same_as<Cmp, std::less<KeyT>> || std::same_as<Cmp, std::less<>>);
+
+// Immutable compressed set of integers (Elias-Fano). Key minus min key is split in low bits, stored packed,
+// and high bits, stored in unary: bucket of every high part is a run of ones (one per key) ended by zero.
+// It takes about 2 + log2(range / size) bits per key. Positions of every sample_rate-th one and zero are
+// sampled, so select of key by index and search of bucket take constant time plus scan of few words
+template<typename KeyT>
+requires std::integral<KeyT>
+class EliasFanoSet final
+{
+public:
+    using key_type  = KeyT;
+    using size_type = std::size_t;
+
+    static constexpr size_type sample_rate = 256;
+
+private:
+    using word = std::uint64_t;
+    static constexpr size_type word_bits = 64;
+
+    size_type size_ = 0;
+    key_type min_ {};
+    unsigned low_bits_ = 0;
+    std::vector<word> lows_ {};
+    std::vector<word> highs_ {};
+    size_type num_of_high_bits_ = 0;
+    // positions of ones (zeros) with numbers multiple of sample_rate
+    std::vector<size_type> one_samples_ {}, zero_samples_ {};
+
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    EliasFanoSet() = default;
+
+    // keys are sorted and deduplicated unless they already are sorted
+    template<std::input_iterator InpIt>
+    EliasFanoSet(InpIt first, InpIt last)
+    {
+        std::vector<key_type> keys(first, last);
+        if (!std::is_sorted(keys.begin(), keys.end()))
+            std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        size_ = keys.size();
+        if (size_ == 0)
+            return;
+
+        min_ = keys.front();
+        auto range = offset(keys.back());
+        low_bits_ = (range / size_ > 0) ? std::bit_width(range / size_) - 1 : 0;
+        lows_.assign((size_ * low_bits_ + word_bits - 1) / word_bits + 1, 0);
+        num_of_high_bits_ = size_ + (range >> low_bits_) + 1;
+        highs_.assign((num_of_high_bits_ + word_bits - 1) / word_bits, 0);
+
+        for (size_type i = 0; i < size_; i++)
+        {
+            auto value = offset(keys[i]);
+            set_low(i, value & low_mask());
+            auto position = (value >> low_bits_) + i;
+            highs_[position / word_bits] |= word{1} << (position % word_bits);
+        }
+        build_samples();
+    }
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return size_;}
+
+    bool empty() const noexcept {return (size_ == 0);}
+
+    // memory of encoding and directories
+    size_type memory_usage() const noexcept
+    {
+        return sizeof(*this) + (lows_.capacity() + highs_.capacity()) * sizeof(word) +
+               (one_samples_.capacity() + zero_samples_.capacity()) * sizeof(size_type);
+    }
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| Lookup start |=--------------------------------------------
+    // index < size()
+    key_type kth_smallest(size_type index) const noexcept
+    {
+        auto high = select_one(index) - index;
+        return static_cast<key_type>(static_cast<std::uint64_t>(min_) + ((high << low_bits_) | low(index)));
+    }
+
+    bool contains(const key_type& key) const noexcept
+    {
+        if (empty() || key < min_)
+            return false;
+        auto value = offset(key);
+        auto [first, last] = bucket(value >> low_bits_);
+        auto index = search(first, last, value & low_mask(), false);
+        return index != last && low(index) == (value & low_mask());
+    }
+
+    size_type number_less_than(const key_type& key) const noexcept
+    {
+        if (empty() || key <= min_)
+            return 0;
+        auto value = offset(key);
+        auto [first, last] = bucket(value >> low_bits_);
+        return search(first, last, value & low_mask(), false);
+    }
+
+    size_type number_not_greater_than(const key_type& key) const noexcept
+    {
+        if (empty() || key < min_)
+            return 0;
+        auto value = offset(key);
+        auto [first, last] = bucket(value >> low_bits_);
+        return search(first, last, value & low_mask(), true);
+    }
+
+    // number of keys in [first, last]
+    size_type count_in_range(const key_type& first, const key_type& last) const noexcept
+    {
+        if (last < first)
+            return 0;
+        return number_not_greater_than(last) - number_less_than(first);
+    }
+//----------------------------------------=| Lookup end |=----------------------------------------------
+
+//----------------------------------------=| Encoding start |=------------------------------------------
+private:
+    // distance from min key, wraps correctly for signed keys
+    std::uint64_t offset(const key_type& key) const noexcept
+    {
+        return static_cast<std::uint64_t>(key) - static_cast<std::uint64_t>(min_);
+    }
+
+    word low_mask() const noexcept {return low_bits_ ? (~word{0} >> (word_bits - low_bits_)) : 0;}
+
+    word low(size_type index) const noexcept
+    {
+        if (low_bits_ == 0)
+            return 0;
+        auto bit = index * low_bits_;
+        auto shift = bit % word_bits;
+        auto value = lows_[bit / word_bits] >> shift;
+        if (shift + low_bits_ > word_bits)
+            value |= lows_[bit / word_bits + 1] << (word_bits - shift);
+        return value & low_mask();
+    }
+
+    void set_low(size_type index, word value) noexcept
+    {
+        if (low_bits_ == 0)
+            return;
+        auto bit = index * low_bits_;
+        auto shift = bit % word_bits;
+        lows_[bit / word_bits] |= value << shift;
+        if (shift + low_bits_ > word_bits)
+            lows_[bit / word_bits + 1] |= value >> (word_bits - shift);
+    }
+
+    void build_samples()
+    {
+        size_type ones = 0, zeros = 0;
+        for (size_type position = 0; position < num_of_high_bits_; position++)
+        {
+            if (highs_[position / word_bits] >> (position % word_bits) & 1)
+            {
+                if (ones++ % sample_rate == 0)
+                    one_samples_.push_back(position);
+            }
+            else if (zeros++ % sample_rate == 0)
+                zero_samples_.push_back(position);
+        }
+    }
+
+    // position of set bit number rank in word
+    static size_type select_in_word(word bits, size_type rank) noexcept
+    {
+        for (; rank > 0; rank--)
+            bits &= bits - 1;
+        return std::countr_zero(bits);
+    }
+
+    // position of one (or zero) number rank, Ones chooses kind of bits
+    template<bool Ones>
+    size_type select(size_type rank, const std::vector<size_type>& samples) const noexcept
+    {
+        auto position = samples[rank / sample_rate];
+        rank %= sample_rate;
+        auto index = position / word_bits;
+        auto bits = Ones ? highs_[index] : ~highs_[index];
+        // bits before sampled position are not counted
+        bits &= ~word{0} << (position % word_bits);
+        while (true)
+        {
+            auto count = static_cast<size_type>(std::popcount(bits));
+            if (rank < count)
+                return index * word_bits + select_in_word(bits, rank);
+            rank -= count;
+            index++;
+            bits = Ones ? highs_[index] : ~highs_[index];
+        }
+    }
+
+    size_type select_one(size_type rank) const noexcept {return select<true>(rank, one_samples_);}
+
+    size_type select_zero(size_type rank) const noexcept {return select<false>(rank, zero_samples_);}
+
+    // indexes [first, last) of keys with high part equal to high
+    std::pair<size_type, size_type> bucket(std::uint64_t high) const noexcept
+    {
+        // buckets after the last one are empty
+        auto buckets = num_of_high_bits_ - size_;
+        if (high >= buckets)
+            return {size_, size_};
+        auto first = high ? select_zero(high - 1) + 1 - high : 0;
+        auto last  = select_zero(high) - high;
+        return {first, last};
+    }
+
+    // first index in [first, last) with low part greater (or not less) than value, lows are sorted in bucket
+    size_type search(size_type first, size_type last, word value, bool greater) const noexcept
+    {
+        while (first < last)
+        {
+            auto middle = first + (last - first) / 2;
+            auto current = low(middle);
+            if (current < value || (greater && current == value))
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return first;
+    }
+//----------------------------------------=| Encoding end |=--------------------------------------------
+}; // class EliasFanoSet
+} // namespace Container
@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace Container
+{
+
+// Immutable sorted set for phases without updates. Keys are stored sorted in blocks of one cache line,
+// last keys of blocks form index in Eytzinger (BFS) order. Search descends index without branches
+// on keys, prefetching nodes few levels below, then counts keys of one block with fixed-length loop,
+// which compilers vectorize for arithmetic keys. Rank of key is position of its block plus count
+template<typename KeyT, class Cmp = std::less<KeyT>>
+class FrozenSet final
+{
+public:
+    using key_type       = KeyT;
+    using size_type      = std::size_t;
+    using const_iterator = const key_type*;
+
+    // keys of one cache line, one key for large ones
+    static constexpr size_type block_size = std::max<size_type>(1, 64 / sizeof(key_type));
+
+private:
+    // last block is padded by copies of max key, ranks are clamped by size
+    std::vector<key_type> keys_ {};
+    size_type size_ = 0;
+    // index_[k] is last key of block blocks_[k], children of k are 2k and 2k + 1, index_[0] is unused
+    std::vector<key_type> index_ {};
+    std::vector<size_type> blocks_ {};
+
+    Cmp cmp {};
+
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    FrozenSet() = default;
+
+    // keys are sorted and deduplicated unless they already are sorted
+    template<std::input_iterator InpIt>
+    FrozenSet(InpIt first, InpIt last, Cmp comparator = Cmp{})
+    :keys_(first, last), cmp {comparator}
+    {
+        if (!std::is_sorted(keys_.begin(), keys_.end(), cmp))
+            std::sort(keys_.begin(), keys_.end(), cmp);
+        keys_.erase(std::unique(keys_.begin(), keys_.end(), [this](const key_type& lhs, const key_type& rhs)
+                                {return !cmp(lhs, rhs);}), keys_.end());
+        size_ = keys_.size();
+        if (size_ == 0)
+            return;
+
+        auto num_of_blocks = (size_ + block_size - 1) / block_size;
+        keys_.resize(num_of_blocks * block_size, keys_.back());
+        index_.resize(num_of_blocks + 1);
+        blocks_.resize(num_of_blocks + 1);
+        size_type block = 0;
+        build_index(1, block);
+    }
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return size_;}
+
+    bool empty() const noexcept {return (size_ == 0);}
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| Iterators start |=-----------------------------------------
+    const_iterator begin() const noexcept {return keys_.data();}
+    const_iterator end()   const noexcept {return keys_.data() + size_;}
+//----------------------------------------=| Iterators end |=-------------------------------------------
+
+//----------------------------------------=| Lookup start |=--------------------------------------------
+    const_iterator lower_bound(const key_type& key) const noexcept {return begin() + number_less_than(key);}
+
+    const_iterator upper_bound(const key_type& key) const noexcept {return begin() + number_not_greater_than(key);}
+
+    bool contains(const key_type& key) const noexcept
+    {
+        auto itr = lower_bound(key);
+        return itr != end() && !cmp(key, *itr);
+    }
+
+    size_type number_less_than(const key_type& key) const noexcept
+    {
+        return rank([this, &key](const key_type& other) {return cmp(other, key);});
+    }
+
+    size_type number_not_greater_than(const key_type& key) const noexcept
+    {
+        return rank([this, &key](const key_type& other) {return !cmp(key, other);});
+    }
+
+    // number of keys in [first, last]
+    size_type count_in_range(const key_type& first, const key_type& last) const noexcept
+    {
+        if (cmp(last, first))
+            return 0;
+        return number_not_greater_than(last) - number_less_than(first);
+    }
+//----------------------------------------=| Lookup end |=----------------------------------------------
+
+//----------------------------------------=| Search start |=--------------------------------------------
+private:
+    // in-order traversal of implicit tree gives blocks in sorted order
+    void build_index(size_type k, size_type& block) noexcept
+    {
+        if (k >= index_.size())
+            return;
+        build_index(2 * k, block);
+        index_[k]  = keys_[block * block_size + block_size - 1];
+        blocks_[k] = block++;
+        build_index(2 * k + 1, block);
+    }
+
+    // number of keys for which before(key) is true, before is true for prefix of keys
+    template<typename Before>
+    size_type rank(Before before) const noexcept
+    {
+        if (size_ == 0)
+            return 0;
+
+        // first block whose last key is not before, prefetched line holds descendants log2(lane) levels below
+        constexpr size_type lane = std::max<size_type>(1, 64 / sizeof(key_type));
+        size_type k = 1, nodes = index_.size();
+        while (k < nodes)
+        {
+            if (k * lane < nodes)
+                __builtin_prefetch(index_.data() + k * lane);
+            k = 2 * k + static_cast<size_type>(before(index_[k]));
+        }
+        // turns right after the found node are cancelled
+        k >>= std::countr_one(k) + 1;
+        if (k == 0)
+            return size_;
+
+        auto block = blocks_[k];
+        const key_type* keys = keys_.data() + block * block_size;
+        size_type count = 0;
+        for (size_type i = 0; i < block_size; i++)
+            count += static_cast<size_type>(before(keys[i]));
+        return std::min(block * block_size + count, size_);
+    }
+//----------------------------------------=| Search end |=----------------------------------------------
+}; // class FrozenSet
+} // namespace Container
@@ -0,0 +1,220 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Container
+{
+
+// numeric keys in natural order, positions of them are modelled by lines
+template<typename KeyT, class Cmp>
+concept learned_indexable = std::is_arithmetic_v<KeyT> && (std::same_as<Cmp, std::less<KeyT>> || std::same_as<Cmp, std::less<>>);
+
+// Immutable sorted set with learned index (as PGM-index). Positions of sorted keys are approximated
+// by piecewise linear model with error at most epsilon, first keys of segments are approximated
+// by model of next level in the same way up to level of one segment. Query descends levels, every level
+// costs binary search in window of 2 * epsilon + 3 keys, which are few cache lines
+template<typename KeyT>
+requires std::is_arithmetic_v<KeyT>
+class LearnedSet final
+{
+public:
+    using key_type       = KeyT;
+    using size_type      = std::size_t;
+    using const_iterator = const key_type*;
+
+private:
+    // position of key is first + slope * (key - first key of segment)
+    struct Segment
+    {
+        size_type first_;
+        double slope_;
+    };
+
+    // model of level approximates positions in keys of previous level (keys_ for the first one)
+    struct Level
+    {
+        std::vector<key_type> keys_ {};   // first keys of segments
+        std::vector<Segment> segments_ {};
+    };
+
+    size_type epsilon_ = 32;
+    std::vector<key_type> keys_ {};
+    std::vector<Level> levels_ {};
+
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    LearnedSet() = default;
+
+    // keys are sorted and deduplicated unless they already are sorted, model is built in O(n)
+    template<std::input_iterator InpIt>
+    LearnedSet(InpIt first, InpIt last, size_type epsilon = 32)
+    :epsilon_ {epsilon}, keys_(first, last)
+    {
+        if (epsilon_ == 0)
+            throw std::invalid_argument{"LearnedSet: epsilon should be positive"};
+        if (!std::is_sorted(keys_.begin(), keys_.end()))
+            std::sort(keys_.begin(), keys_.end());
+        keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+        if (keys_.empty())
+            return;
+
+        levels_.push_back(fit(keys_));
+        while (levels_.back().segments_.size() > 1)
+        {
+            // reference to keys of last level is invalidated by push_back
+            auto level = fit(levels_.back().keys_);
+            levels_.push_back(std::move(level));
+        }
+    }
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return keys_.size();}
+
+    bool empty() const noexcept {return keys_.empty();}
+
+    size_type epsilon() const noexcept {return epsilon_;}
+
+    // number of segments on every level, the first level models keys
+    std::vector<size_type> segments() const
+    {
+        std::vector<size_type> sizes {};
+        for (auto& level: levels_)
+            sizes.push_back(level.segments_.size());
+        return sizes;
+    }
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| Iterators start |=-----------------------------------------
+    const_iterator begin() const noexcept {return keys_.data();}
+    const_iterator end()   const noexcept {return keys_.data() + keys_.size();}
+//----------------------------------------=| Iterators end |=-------------------------------------------
+
+//----------------------------------------=| Lookup start |=--------------------------------------------
+    const_iterator lower_bound(const key_type& key) const noexcept {return begin() + number_less_than(key);}
+
+    const_iterator upper_bound(const key_type& key) const noexcept {return begin() + number_not_greater_than(key);}
+
+    const_iterator find(const key_type& key) const noexcept
+    {
+        auto itr = lower_bound(key);
+        return (itr != end() && *itr == key) ? itr : end();
+    }
+
+    bool contains(const key_type& key) const noexcept {return find(key) != end();}
+
+    size_type number_less_than(const key_type& key) const noexcept
+    {
+        return rank(key, [](const key_type& lhs, const key_type& rhs) {return lhs < rhs;});
+    }
+
+    size_type number_not_greater_than(const key_type& key) const noexcept
+    {
+        return rank(key, [](const key_type& lhs, const key_type& rhs) {return lhs <= rhs;});
+    }
+
+    // number of keys in [first, last]
+    size_type count_in_range(const key_type& first, const key_type& last) const noexcept
+    {
+        if (last < first)
+            return 0;
+        return number_not_greater_than(last) - number_less_than(first);
+    }
+//----------------------------------------=| Lookup end |=----------------------------------------------
+
+//----------------------------------------=| Model start |=---------------------------------------------
+private:
+    // distance between keys without overflow of signed keys
+    static double distance(const key_type& from, const key_type& to) noexcept
+    {
+        if constexpr (std::is_integral_v<key_type>)
+            return static_cast<double>(static_cast<std::uint64_t>(to) - static_cast<std::uint64_t>(from));
+        else
+            return static_cast<double>(to) - static_cast<double>(from);
+    }
+
+    // Greedy cone: line from first point of segment fits next point if some slope keeps all points
+    // within epsilon, cone of such slopes only shrinks, segment ends when it is empty
+    Level fit(const std::vector<key_type>& keys) const
+    {
+        Level level {};
+        auto epsilon = static_cast<double>(epsilon_);
+        size_type first = 0;
+        double low = 0, high = std::numeric_limits<double>::infinity();
+
+        auto close = [&]
+        {
+            auto slope = std::isinf(high) ? low : (low + high) / 2;
+            level.keys_.push_back(keys[first]);
+            level.segments_.push_back(Segment{first, slope});
+        };
+
+        for (size_type i = 1; i < keys.size(); i++)
+        {
+            auto dx = distance(keys[first], keys[i]);
+            auto dy = static_cast<double>(i - first);
+            auto new_low = std::max(low, (dy - epsilon) / dx), new_high = std::min(high, (dy + epsilon) / dx);
+            if (new_low <= new_high)
+            {
+                low = new_low;
+                high = new_high;
+                continue;
+            }
+            close();
+            first = i;
+            low = 0;
+            high = std::numeric_limits<double>::infinity();
+        }
+        close();
+        return level;
+    }
+
+    // Number of keys for which before(key, other) is true in keys, window is predicted by segment
+    // and clamped by first position of next segment. Search falls back to whole range if window misses
+    template<typename Before>
+    size_type search(const std::vector<key_type>& keys, const Level& level, size_type segment,
+                     const key_type& key, Before before) const noexcept
+    {
+        auto& model = level.segments_[segment];
+        auto limit = (segment + 1 < level.segments_.size()) ? level.segments_[segment + 1].first_ : keys.size();
+        auto predicted = static_cast<double>(model.first_) + model.slope_ * distance(level.keys_[segment], key);
+        auto position = static_cast<size_type>(std::clamp(predicted, static_cast<double>(model.first_),
+                                                          static_cast<double>(limit)));
+
+        auto first = (position > epsilon_ + 1) ? position - epsilon_ - 1 : 0;
+        auto last  = std::min(keys.size(), position + epsilon_ + 2);
+        auto result = std::partition_point(keys.begin() + first, keys.begin() + last,
+                                           [&](const key_type& other) {return before(other, key);}) - keys.begin();
+        auto index = static_cast<size_type>(result);
+        if ((index == first && first > 0 && !before(keys[first - 1], key)) ||
+            (index == last && last < keys.size() && before(keys[last], key)))
+            index = std::partition_point(keys.begin(), keys.end(),
+                                         [&](const key_type& other) {return before(other, key);}) - keys.begin();
+        return index;
+    }
+
+    // number of keys for which before(key, other) is true, it is true for prefix of keys
+    template<typename Before>
+    size_type rank(const key_type& key, Before before) const noexcept
+    {
+        if (keys_.empty() || !before(keys_.front(), key))
+            return 0;
+
+        // segment of every level is the last one with first key before or equal to key
+        auto not_greater = [](const key_type& lhs, const key_type& rhs) {return lhs <= rhs;};
+        size_type segment = 0;
+        for (auto level = levels_.size() - 1; level > 0; level--)
+            segment = search(levels_[level - 1].keys_, levels_[level], segment, key, not_greater) - 1;
+        return search(keys_, levels_.front(), segment, key, before);
+    }
+//----------------------------------------=| Model end |=-----------------------------------------------
+}; // class LearnedSet
+} // namespace Container
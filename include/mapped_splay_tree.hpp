@@ -0,0 +1,425 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Container
+{
+
+namespace detail
+{
+// node of mapped tree, all links are offsets (in nodes) relative to this node,
+// zero offset means that there is no such node
+template<typename KeyT>
+struct MappedNode
+{
+    using key_type = KeyT;
+    using node_ptr = const MappedNode*;
+
+    key_type key_ {};
+    std::int64_t parent_ = 0, left_ = 0, right_ = 0;
+    std::uint64_t size_ = 1;
+
+    node_ptr parent() const noexcept {return parent_ ? this + parent_ : nullptr;}
+    node_ptr left()   const noexcept {return left_   ? this + left_   : nullptr;}
+    node_ptr right()  const noexcept {return right_  ? this + right_  : nullptr;}
+
+    bool is_left_son()  const noexcept {return this == parent()->left();}
+    bool is_right_son() const noexcept {return this == parent()->right();}
+};
+
+// header of mapped file, nodes start right after it
+struct MappedHeader
+{
+    static constexpr char magic[8] = {'S', 'P', 'L', 'Y', 'M', 'A', 'P', '1'};
+
+    char magic_[8] {};
+    std::uint32_t key_size_  = 0;
+    std::uint32_t node_size_ = 0;
+    std::uint64_t size_ = 0;
+    // indexes of root, min and max nodes in node array
+    std::uint64_t root_ = 0, min_ = 0, max_ = 0;
+    char reserved_[16] {};
+};
+static_assert(sizeof(MappedHeader) == 64);
+
+template<typename KeyT>
+class MappedTreeIterator
+{
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = KeyT;
+    using const_pointer     = const KeyT*;
+    using const_reference   = const KeyT&;
+    using node_ptr          = const MappedNode<KeyT>*;
+private:
+    node_ptr node_, max_;
+public:
+    MappedTreeIterator(node_ptr node = nullptr, node_ptr max = nullptr) noexcept
+    :node_ {node}, max_ {max}
+    {}
+
+    const_reference operator*() const noexcept {return node_->key_;}
+
+    const_pointer operator->() const noexcept {return std::addressof(node_->key_);}
+
+    MappedTreeIterator& operator++() noexcept
+    {
+        if (node_->right())
+            for (node_ = node_->right(); node_->left(); node_ = node_->left()) {}
+        else
+        {
+            auto parent = node_->parent();
+            while (parent && node_->is_right_son())
+            {
+                node_ = parent;
+                parent = parent->parent();
+            }
+            node_ = parent;
+        }
+        return *this;
+    }
+
+    MappedTreeIterator operator++(int) noexcept
+    {
+        auto cpy {*this};
+        ++(*this);
+        return cpy;
+    }
+
+    MappedTreeIterator& operator--() noexcept
+    {
+        if (!node_)
+            node_ = max_;
+        else if (node_->left())
+            for (node_ = node_->left(); node_->right(); node_ = node_->right()) {}
+        else
+        {
+            auto parent = node_->parent();
+            while (parent && node_->is_left_son())
+            {
+                node_ = parent;
+                parent = parent->parent();
+            }
+            node_ = parent;
+        }
+        return *this;
+    }
+
+    MappedTreeIterator operator--(int) noexcept
+    {
+        auto cpy {*this};
+        --(*this);
+        return cpy;
+    }
+
+    bool operator==(const MappedTreeIterator& rhs) const noexcept {return (node_ == rhs.node_ && max_ == rhs.max_);}
+}; // class MappedTreeIterator
+} // namespace detail
+
+// Read-only search tree living in memory mapped file.
+// Nodes are linked by relative offsets, so file is opened without any deserialization
+// and pages are loaded on demand. Tree is written balanced in BFS order: top levels
+// share first pages of file. Lookups do not splay: file is shared between processes.
+template<typename KeyT, class Cmp = std::less<KeyT>>
+class MappedSplayTree final
+{
+    static_assert(std::is_trivially_copyable_v<KeyT>, "mapped keys must be trivially copyable");
+public:
+    using node_type      = detail::MappedNode<KeyT>;
+    using const_node_ptr = const node_type*;
+    using key_type       = KeyT;
+    using size_type      = std::size_t;
+
+    using ConstIterator = detail::MappedTreeIterator<key_type>;
+    using Iterator      = ConstIterator;
+
+private:
+    using header_type = detail::MappedHeader;
+
+    void*     map_  = nullptr;
+    size_type map_size_ = 0;
+
+    const_node_ptr root_ = nullptr, min_ = nullptr, max_ = nullptr;
+    size_type size_ = 0;
+
+    Cmp cmp {};
+
+    bool key_less(const key_type& key1, const key_type& key2) const {return cmp(key1, key2);}
+    bool key_equal(const key_type& key1, const key_type& key2) const
+    {
+        return !cmp(key1, key2) && !cmp(key2, key1);
+    }
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    MappedSplayTree() = default;
+
+    explicit MappedSplayTree(const std::string& filename)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error{"MappedSplayTree: can't open " + filename};
+
+        struct stat st {};
+        if (::fstat(fd, &st) == -1 || static_cast<size_type>(st.st_size) < sizeof(header_type))
+        {
+            ::close(fd);
+            throw std::runtime_error{"MappedSplayTree: " + filename + " is not a mapped tree"};
+        }
+
+        map_size_ = st.st_size;
+        map_ = ::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map_ == MAP_FAILED)
+        {
+            map_ = nullptr;
+            throw std::runtime_error{"MappedSplayTree: can't map " + filename};
+        }
+        // descents touch nodes all over the file, readahead only wastes page cache
+        ::madvise(map_, map_size_, MADV_RANDOM);
+
+        auto header = static_cast<const header_type*>(map_);
+        if (std::memcmp(header->magic_, header_type::magic, sizeof(header_type::magic)) ||
+            header->key_size_ != sizeof(key_type) || header->node_size_ != sizeof(node_type) ||
+            map_size_ != sizeof(header_type) + header->size_ * sizeof(node_type))
+        {
+            unmap();
+            throw std::runtime_error{"MappedSplayTree: " + filename + " has incompatible format"};
+        }
+
+        size_ = header->size_;
+        if (size_)
+        {
+            auto nodes = nodes_begin();
+            root_ = nodes + header->root_;
+            min_  = nodes + header->min_;
+            max_  = nodes + header->max_;
+        }
+    }
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Big five start |=------------------------------------------
+    MappedSplayTree(const MappedSplayTree&) = delete;
+    MappedSplayTree& operator=(const MappedSplayTree&) = delete;
+
+    MappedSplayTree(MappedSplayTree&& other) noexcept
+    {
+        swap(other);
+    }
+    MappedSplayTree& operator=(MappedSplayTree&& rhs) noexcept
+    {
+        swap(rhs);
+        return *this;
+    }
+
+    ~MappedSplayTree()
+    {
+        unmap();
+    }
+
+private:
+    void swap(MappedSplayTree& rhs) noexcept
+    {
+        std::swap(map_, rhs.map_);
+        std::swap(map_size_, rhs.map_size_);
+        std::swap(root_, rhs.root_);
+        std::swap(min_, rhs.min_);
+        std::swap(max_, rhs.max_);
+        std::swap(size_, rhs.size_);
+    }
+
+    void unmap() noexcept
+    {
+        if (map_)
+            ::munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+
+    const_node_ptr nodes_begin() const noexcept
+    {
+        return reinterpret_cast<const_node_ptr>(static_cast<const char*>(map_) + sizeof(header_type));
+    }
+//----------------------------------------=| Big five end |=--------------------------------------------
+
+//----------------------------------------=| Write start |=---------------------------------------------
+public:
+    // write sorted unique range [first, last) into file as balanced tree
+    template<std::input_iterator InpIt>
+    static void write(const std::string& filename, InpIt first, InpIt last)
+    {
+        std::vector<key_type> keys (first, last);
+
+        std::ofstream file {filename, std::ios::binary | std::ios::trunc};
+        if (!file)
+            throw std::runtime_error{"MappedSplayTree: can't create " + filename};
+
+        header_type header {};
+        std::memcpy(header.magic_, header_type::magic, sizeof(header_type::magic));
+        header.key_size_  = sizeof(key_type);
+        header.node_size_ = sizeof(node_type);
+        header.size_ = keys.size();
+
+        // subtree of balanced tree is range of keys, its root is middle of range,
+        // ranges are numbered in BFS order, so number of range is index of its node
+        struct Range {size_type first, last, parent;};
+        std::vector<Range> queue {};
+        queue.reserve(keys.size());
+        if (!keys.empty())
+            queue.push_back(Range{0, keys.size(), 0});
+
+        // find indexes of min and max: most left and most right nodes
+        for (size_type i = 0; i < keys.size(); i++)
+        {
+            auto [lo, hi, parent] = queue[i];
+            auto mid = lo + (hi - lo) / 2;
+            if (mid == 0)
+                header.min_ = i;
+            if (mid == keys.size() - 1)
+                header.max_ = i;
+            if (lo < mid)
+                queue.push_back(Range{lo, mid, i});
+            if (mid + 1 < hi)
+                queue.push_back(Range{mid + 1, hi, i});
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        // sons of node are pushed in queue one after another, so left son (if exists)
+        // goes before right son and index of first son is one more than last son of previous node
+        size_type next_son = 1;
+        for (size_type i = 0; i < keys.size(); i++)
+        {
+            auto [lo, hi, parent] = queue[i];
+            auto mid = lo + (hi - lo) / 2;
+
+            node_type node {};
+            node.key_  = keys[mid];
+            node.size_ = hi - lo;
+            if (i)
+                node.parent_ = static_cast<std::int64_t>(parent) - static_cast<std::int64_t>(i);
+            if (lo < mid)
+                node.left_ = static_cast<std::int64_t>(next_son++) - static_cast<std::int64_t>(i);
+            if (mid + 1 < hi)
+                node.right_ = static_cast<std::int64_t>(next_son++) - static_cast<std::int64_t>(i);
+            file.write(reinterpret_cast<const char*>(&node), sizeof(node));
+        }
+
+        if (!file)
+            throw std::runtime_error{"MappedSplayTree: can't write " + filename};
+    }
+
+    template<typename Tree>
+    static void write(const std::string& filename, const Tree& tree)
+    {
+        write(filename, tree.cbegin(), tree.cend());
+    }
+//----------------------------------------=| Write end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return size_;}
+
+    bool empty() const noexcept {return (size_ == 0);}
+
+    const key_type& maximum() const noexcept {return max_->key_;}
+    const key_type& minimum() const noexcept {return min_->key_;}
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| begin/end start |=-----------------------------------------
+    ConstIterator begin() const noexcept {return ConstIterator{min_, max_};}
+    ConstIterator end()   const noexcept {return ConstIterator{nullptr, max_};}
+
+    ConstIterator cbegin() const noexcept {return ConstIterator{min_, max_};}
+    ConstIterator cend()   const noexcept {return ConstIterator{nullptr, max_};}
+//----------------------------------------=| begin/end end |=-------------------------------------------
+
+//----------------------------------------=| Find start |=----------------------------------------------
+    ConstIterator find(const key_type& key) const
+    {
+        auto node = root_;
+        while (node)
+            if (key_less(key, node->key_))
+                node = node->left();
+            else if (key_less(node->key_, key))
+                node = node->right();
+            else
+                return ConstIterator{node, max_};
+        return end();
+    }
+//----------------------------------------=| Find end |=------------------------------------------------
+
+//----------------------------------------=| Bounds start |=--------------------------------------------
+    ConstIterator lower_bound(const key_type& key) const
+    {
+        const_node_ptr result = nullptr, current = root_;
+        while (current)
+            if (!key_less(current->key_, key))
+            {
+                result = current;
+                current = current->left();
+            }
+            else
+                current = current->right();
+        return ConstIterator{result, max_};
+    }
+
+    ConstIterator upper_bound(const key_type& key) const
+    {
+        const_node_ptr result = nullptr, current = root_;
+        while (current)
+            if (key_less(key, current->key_))
+            {
+                result = current;
+                current = current->left();
+            }
+            else
+                current = current->right();
+        return ConstIterator{result, max_};
+    }
+//----------------------------------------=| Bounds end |=----------------------------------------------
+
+//----------------------------------------=| Rank start |=----------------------------------------------
+    size_type number_less_than(const key_type& key) const
+    {
+        size_type number = 0;
+        auto current = root_;
+        while (current)
+            if (key_less(current->key_, key))
+            {
+                if (current->left())
+                    number += current->left()->size_;
+                number += 1;
+                current = current->right();
+            }
+            else
+                current = current->left();
+        return number;
+    }
+
+    size_type number_not_greater_than(const key_type& key) const
+    {
+        size_type number = 0;
+        auto current = root_;
+        while (current)
+            if (!key_less(key, current->key_))
+            {
+                if (current->left())
+                    number += current->left()->size_;
+                number += 1;
+                current = current->right();
+            }
+            else
+                current = current->left();
+        return number;
+    }
+//----------------------------------------=| Rank end |=------------------------------------------------
+}; // class MappedSplayTree
+} // namespace Container
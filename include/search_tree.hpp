@@ -1,9 +1,16 @@
 #pragma once
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <cassert>
+#include <cmath>
+#include <future>
+#include <system_error>
+#include <thread>
+#include <vector>
 #include "tree.hpp"
 #include "search_tree_iterator.hpp"
+#include "tree_stats.hpp"
 
 namespace Container
 {
@@ -29,12 +36,25 @@ protected:
 
     Cmp cmp {};
 
-    bool key_less(const key_type& key1, const key_type& key2) const {return cmp(key1, key2);}
+    [[no_unique_address]] mutable detail::StatsCounter<> stats_ {};
+
+    bool key_less(const key_type& key1, const key_type& key2) const
+    {
+        stats_.comparison();
+        return cmp(key1, key2);
+    }
     bool key_equal(const key_type& key1, const key_type& key2) const
     {
+        stats_.comparison(2);
         return !cmp(key1, key2) && !cmp(key2, key1);
     }
 
+    // depth of descent is depth of its last visited node (0 for root) for hits and misses alike
+    void count_descent(size_type visited) const
+    {
+        stats_.descent(visited ? visited - 1 : 0);
+    }
+
     using base::cast;
 //----------------------------------------=| Ctors start |=---------------------------------------------
 public:
@@ -85,13 +105,18 @@ protected:
     ConstIterator find_key(const key_type& key) const
     {
         node_ptr node = root_;
-        while (node)
+        size_type depth = 0;
+        for (; node; depth++)
             if (key_less(key, node->key_))
                 node = cast(node->left_);
             else if (key_less(node->key_, key))
                 node = cast(node->right_);
             else
+            {
+                count_descent(depth + 1);
                 return ConstIterator{node, max_};
+            }
+        count_descent(depth);
         return end();
     }
 public:
@@ -112,6 +137,7 @@ protected:
             return std::pair{ConstIterator{parent, max_}, false};
 
         auto new_node = new node_type(std::move(key));
+        stats_.allocation();
         new_node->parent_ = parent;
         insert_in_place(new_node);
         return std::pair{ConstIterator{new_node, max_}, true};
@@ -122,8 +148,9 @@ private:
     {
         node_ptr x = root_;
         node_ptr y = nullptr;
+        size_type depth = 0;
 
-        while (x)
+        for (; x; depth++)
         {
             // save pointer on x before turn
             y = x;
@@ -132,10 +159,12 @@ private:
                 x = cast(x->left_);
             // else turn right
             else if (key_equal(key, x->key_))
-                return x;
+                break;
             else
                 x = cast(x->right_);
         }
+        // loop stops on equal key before depth is incremented
+        count_descent(x ? depth + 1 : depth);
         return y;
     }
 
@@ -293,8 +322,11 @@ protected:
             //first arrow on picture
             // if y right son of z
             if (y->parent_ == z)
-                // only set parent of x as y
-                x->parent_ = y;
+            {
+                // only set parent of x as y, if y has right son
+                if (x)
+                    x->parent_ = y;
+            }
             else
             {
                 // replace y with right subtree of y
@@ -325,6 +357,7 @@ public:
         auto node = itr.base();
         erase_from_tree(node);
         delete node;
+        stats_.free();
         return itr_next;
     }
 
@@ -347,7 +380,8 @@ protected:
     node_ptr lower_bound_ptr(const key_type& key) const
     {
         node_ptr result = nullptr, current = root_;
-        while (current)
+        size_type depth = 0;
+        for (; current; depth++)
             if (!key_less(current->key_, key))
             {
                 result = current;
@@ -355,13 +389,15 @@ protected:
             }
             else
                 current = cast(current->right_);
+        count_descent(depth);
         return result;
     }
 
     node_ptr upper_bound_ptr(const key_type& key) const 
     {
         node_ptr result = nullptr, current = root_;
-        while (current)
+        size_type depth = 0;
+        for (; current; depth++)
             if (key_less(key, current->key_))
             {
                 result = current;
@@ -369,6 +405,7 @@ protected:
             }
             else
                 current = cast(current->right_);
+        count_descent(depth);
         return result;
     }
 
@@ -377,7 +414,321 @@ public:
     virtual ConstIterator upper_bound(const key_type& key) const {return ConstIterator{upper_bound_ptr(key), max_};}
 //----------------------------------------=| Bounds end |=----------------------------------------------
 
+//----------------------------------------=| Batch lookup start |=--------------------------------------
+    // number of descents in flight, enough to cover latency of miss with misses of others
+    static constexpr size_type batch_group = 16;
+
+    // Lookups of keys [first, last) without splaying, results are in order of keys. Descents of batch_group
+    // keys take turns level by level and node of next level is prefetched, so misses of different descents
+    // overlap instead of stalling one by one. Pays off on trees larger than cache
+    template<std::random_access_iterator RandIt>
+    std::vector<ConstIterator> find_batch(RandIt first, RandIt last) const
+    {
+        return to_iterators(find_batch_ptr(first, last));
+    }
+
+    template<std::random_access_iterator RandIt>
+    std::vector<ConstIterator> lower_bound_batch(RandIt first, RandIt last) const
+    {
+        return to_iterators(lower_bound_batch_ptr(first, last));
+    }
+
+    // Lookups of keys [first, last), sorted by comparator, in one descent: keys are split by every node,
+    // so common prefix of their paths is visited once and neighbouring keys share nodes in cache
+    template<std::random_access_iterator RandIt>
+    std::vector<ConstIterator> find_sorted_batch(RandIt first, RandIt last) const
+    {
+        return to_iterators(find_sorted_batch_ptr(first, last));
+    }
+
+protected:
+    template<std::random_access_iterator RandIt>
+    std::vector<node_ptr> find_sorted_batch_ptr(RandIt first, RandIt last) const
+    {
+        std::vector<node_ptr> result(last - first, nullptr);
+        sorted_descent(first, result.size(), [](node_ptr) -> size_type {return 0;},
+                       [&](node_ptr node, size_type equal_first, size_type equal_last, size_type)
+                       {std::fill(result.begin() + equal_first, result.begin() + equal_last, node);},
+                       [](node_ptr, size_type, size_type, size_type) {});
+        return result;
+    }
+
+    // Splits sorted keys [0, count) by keys of nodes from root down: less keys go to left subtree, greater
+    // ones to right subtree. Offset of subtree is number of keys before it, left_size(node) gives number
+    // of keys in left subtree (0 if rank is not needed). found(node, first, last, rank) gets keys equal
+    // to key of node, missed(parent, first, last, offset) gets keys which fell out of tree below parent
+    template<std::random_access_iterator RandIt, typename LeftSize, typename Found, typename Missed>
+    void sorted_descent(RandIt keys, size_type count, LeftSize left_size, Found found, Missed missed) const
+    {
+        struct Part
+        {
+            node_ptr node, parent;
+            size_type first, last, offset;
+        };
+        std::vector<Part> stack {};
+        if (count)
+            stack.push_back(Part{root_, nullptr, 0, count, 0});
+
+        while (!stack.empty())
+        {
+            auto [node, parent, first, last, offset] = stack.back();
+            stack.pop_back();
+            if (!node)
+            {
+                missed(parent, first, last, offset);
+                continue;
+            }
+
+            auto less = static_cast<size_type>(std::partition_point(keys + first, keys + last,
+                [&](const key_type& key) {return key_less(key, node->key_);}) - keys);
+            auto greater = static_cast<size_type>(std::partition_point(keys + less, keys + last,
+                [&](const key_type& key) {return !key_less(node->key_, key);}) - keys);
+            auto rank = offset + left_size(node);
+            if (less < greater)
+                found(node, less, greater, rank);
+            // left part is popped first, so nodes are visited in order of keys
+            if (greater < last)
+                stack.push_back(Part{cast(node->right_), node, greater, last, rank + 1});
+            if (first < less)
+                stack.push_back(Part{cast(node->left_), node, first, less, offset});
+        }
+    }
+
+    template<std::random_access_iterator RandIt>
+    std::vector<node_ptr> find_batch_ptr(RandIt first, RandIt last) const
+    {
+        std::vector<node_ptr> result(last - first, nullptr);
+        interleave(result.size(), [&](size_type index, node_ptr node) -> node_ptr
+        {
+            auto& key = first[index];
+            if (key_less(key, node->key_))
+                return cast(node->left_);
+            if (key_less(node->key_, key))
+                return cast(node->right_);
+            result[index] = node;
+            return nullptr;
+        });
+        return result;
+    }
+
+    template<std::random_access_iterator RandIt>
+    std::vector<node_ptr> lower_bound_batch_ptr(RandIt first, RandIt last) const
+    {
+        std::vector<node_ptr> result(last - first, nullptr);
+        interleave(result.size(), [&](size_type index, node_ptr node) -> node_ptr
+        {
+            if (key_less(node->key_, first[index]))
+                return cast(node->right_);
+            result[index] = node;
+            return cast(node->left_);
+        });
+        return result;
+    }
+
+    // Runs descents from root for indexes [0, count) by groups. step(index, node) visits node on descent
+    // for index and returns next node, nullptr ends descent. Slot of ended descent takes next index
+    template<typename Step>
+    void interleave(size_type count, Step step) const
+    {
+        if (!root_)
+            return;
+
+        struct Descent
+        {
+            node_ptr node;
+            size_type index, depth;
+        };
+        std::array<Descent, batch_group> group {};
+        size_type active = 0, next = 0;
+        for (; active < batch_group && next < count; active++)
+            group[active] = Descent{root_, next++, 0};
+
+        while (active)
+            for (size_type i = 0; i < active;)
+            {
+                auto& descent = group[i];
+                auto node = step(descent.index, descent.node);
+                descent.depth++;
+                if (node)
+                {
+                    __builtin_prefetch(node);
+                    descent.node = node;
+                    i++;
+                    continue;
+                }
+                count_descent(descent.depth);
+                if (next < count)
+                    descent = Descent{root_, next++, 0};
+                else
+                    descent = group[--active];
+            }
+    }
+
+    std::vector<ConstIterator> to_iterators(const std::vector<node_ptr>& nodes) const
+    {
+        std::vector<ConstIterator> iterators {};
+        iterators.reserve(nodes.size());
+        for (auto node: nodes)
+            iterators.emplace_back(node, max_);
+        return iterators;
+    }
+//----------------------------------------=| Batch lookup end |=----------------------------------------
+
+//----------------------------------------=| Balanced build start |=------------------------------------
+protected:
+    // nodes of subtree in sorted order, O(size of subtree) time
+    static void collect_nodes(node_ptr root, std::vector<node_ptr>& nodes)
+    {
+        auto node = cast(detail::find_min(root));
+        while (node)
+        {
+            nodes.push_back(node);
+            if (node->right_)
+                node = cast(detail::find_min(node->right_));
+            else
+            {
+                while (node != root && node->is_right_son())
+                    node = cast(node->parent_);
+                node = (node == root) ? nullptr : cast(node->parent_);
+            }
+        }
+    }
+
+    // links sorted nodes in balanced tree, returns its root with given parent.
+    // Sizes of augmented nodes are recalculated bottom-up
+    static node_ptr link_balanced(node_ptr* first, node_ptr* last, node_ptr parent) noexcept
+    {
+        if (first == last)
+            return nullptr;
+        auto middle = first + (last - first) / 2;
+        auto root   = *middle;
+        root->parent_ = parent;
+        root->left_   = link_balanced(first, middle, root);
+        root->right_  = link_balanced(middle + 1, last, root);
+        if constexpr (requires {root->calc_size();})
+            root->calc_size();
+        return root;
+    }
+
+    // subproblems smaller than this are not worth thread
+    static constexpr size_type parallel_grain = 1 << 15;
+
+private:
+    // runs task(0), ..., task(count - 1) in count threads and rethrows first exception
+    template<typename Task>
+    static void run_parallel(unsigned count, Task task)
+    {
+        std::vector<std::future<void>> futures {};
+        for (unsigned i = 1; i < count; i++)
+            try
+            {
+                futures.push_back(std::async(std::launch::async, task, i));
+            }
+            catch (const std::system_error&)
+            {
+                // no more threads
+                task(i);
+            }
+        task(0);
+        for (auto& future: futures)
+            future.get();
+    }
+
+    // sorts chunks in threads, then merges pairs of neighbour chunks in rounds
+    static void parallel_sort(std::vector<key_type>& keys, const Cmp& cmp, unsigned threads)
+    {
+        threads = static_cast<unsigned>(std::min<size_type>(threads, keys.size() / parallel_grain));
+        if (threads <= 1)
+        {
+            std::sort(keys.begin(), keys.end(), cmp);
+            return;
+        }
+
+        std::vector<size_type> bounds(threads + 1);
+        for (unsigned i = 0; i <= threads; i++)
+            bounds[i] = keys.size() * i / threads;
+        auto chunk = [&](unsigned i) {return keys.begin() + bounds[std::min(i, threads)];};
+
+        run_parallel(threads, [&](unsigned i) {std::sort(chunk(i), chunk(i + 1), cmp);});
+        for (unsigned width = 1; width < threads; width *= 2)
+            run_parallel((threads + 2 * width - 1) / (2 * width), [&](unsigned i)
+            {
+                std::inplace_merge(chunk(2 * width * i), chunk(2 * width * i + width), chunk(2 * width * (i + 1)), cmp);
+            });
+    }
+
+    // allocates nodes for sorted keys and links them like link_balanced, halves of large ranges in threads
+    static node_ptr build_balanced(key_type* keys, node_ptr* nodes, size_type size, node_ptr parent, unsigned threads)
+    {
+        if (threads <= 1 || size < parallel_grain)
+        {
+            for (size_type i = 0; i < size; i++)
+                nodes[i] = new node_type(std::move(keys[i]));
+            return link_balanced(nodes, nodes + size, parent);
+        }
+
+        auto middle = size / 2;
+        std::future<node_ptr> left_future {};
+        try
+        {
+            left_future = std::async(std::launch::async, [=]
+                                     {return build_balanced(keys, nodes, middle, nullptr, threads / 2);});
+        }
+        catch (const std::system_error&)
+        {
+            return build_balanced(keys, nodes, size, parent, 1);
+        }
+        auto right = build_balanced(keys + middle + 1, nodes + middle + 1, size - middle - 1, nullptr, threads - threads / 2);
+        auto left  = left_future.get();
+
+        auto root = nodes[middle] = new node_type(std::move(keys[middle]));
+        root->parent_ = parent;
+        root->left_   = left;
+        root->right_  = right;
+        left->parent_ = right->parent_ = root;
+        if constexpr (requires {root->calc_size();})
+            root->calc_size();
+        return root;
+    }
+
+public:
+    // Replaces content with balanced tree of unique keys of range. Keys are sorted and deduplicated,
+    // then threads allocate and link subtrees of their parts of keys (glibc malloc gives every
+    // thread its own arena), which are stitched by middle nodes
+    template<std::input_iterator InpIt>
+    void build_from(InpIt first, InpIt last, unsigned threads = std::thread::hardware_concurrency())
+    {
+        std::vector<key_type> keys(first, last);
+        parallel_sort(keys, cmp, threads);
+        keys.erase(std::unique(keys.begin(), keys.end(), [this](const key_type& lhs, const key_type& rhs)
+                               {return !cmp(lhs, rhs);}), keys.end());
+
+        std::vector<node_ptr> nodes(keys.size(), nullptr);
+        node_ptr root = nullptr;
+        try
+        {
+            root = build_balanced(keys.data(), nodes.data(), keys.size(), nullptr, threads);
+        }
+        catch (...)
+        {
+            for (auto node: nodes)
+                delete node;
+            throw;
+        }
+
+        // old nodes are freed by destructor of temporary tree
+        base old {std::move(static_cast<base&>(*this))};
+        stats_.free(old.size());
+        root_ = root;
+        size_ = nodes.size();
+        min_  = nodes.empty() ? nullptr : nodes.front();
+        max_  = nodes.empty() ? nullptr : nodes.back();
+        stats_.allocation(nodes.size());
+    }
+//----------------------------------------=| Balanced build end |=--------------------------------------
+
 //----------------------------------------=| Graph dump start |=----------------------------------------  
+public:
     void debug_graph_dump(const std::string& filename) const
     {   
         std::fstream file {filename + ".dot", std::ofstream::out | std::ofstream::trunc};
@@ -425,6 +776,68 @@ private:
     }
 //----------------------------------------=| Graph dump end |=------------------------------------------
 
+//----------------------------------------=| Stats start |=---------------------------------------------
+public:
+    static constexpr bool stats_enabled = detail::stats_enabled;
+
+    TreeStats stats() const noexcept {return stats_.snapshot();}
+    void reset_stats() noexcept {stats_.reset();}
+//----------------------------------------=| Stats end |=-----------------------------------------------
+
+//----------------------------------------=| Shape start |=---------------------------------------------
+    // height, depth histogram and potential of tree in O(n) time and O(height) memory
+    TreeShape shape() const
+    {
+        TreeShape shape {};
+        shape.size = this->size();
+        if (!root_)
+            return shape;
+
+        // post-order traversal, size of subtree is known when node is left
+        struct Frame
+        {
+            node_ptr node;
+            size_type depth, size;
+            int stage;
+        };
+        std::vector<Frame> stack {Frame{root_, 0, 1, 0}};
+        double depth_sum = 0;
+
+        while (!stack.empty())
+        {
+            auto [node, depth, size, stage] = stack.back();
+            if (stage == 0)
+            {
+                if (shape.depth_histogram.size() <= depth)
+                    shape.depth_histogram.resize(depth + 1);
+                shape.depth_histogram[depth]++;
+                depth_sum += depth;
+
+                stack.back().stage = 1;
+                if (node->left_)
+                    stack.push_back(Frame{cast(node->left_), depth + 1, 1, 0});
+            }
+            else if (stage == 1)
+            {
+                stack.back().stage = 2;
+                if (node->right_)
+                    stack.push_back(Frame{cast(node->right_), depth + 1, 1, 0});
+            }
+            else
+            {
+                shape.potential += std::log2(static_cast<double>(size));
+                stack.pop_back();
+                if (!stack.empty())
+                    stack.back().size += size;
+            }
+        }
+
+        shape.height = shape.depth_histogram.size();
+        shape.average_depth = depth_sum / shape.size;
+        return shape;
+    }
+//----------------------------------------=| Shape end |=-----------------------------------------------
+
 //----------------------------------------=| equal_to start |=------------------------------------------
 public:
     bool equal_to(const SearchTree& other) const
@@ -0,0 +1,323 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "splay_tree.hpp"
+
+namespace Container
+{
+
+// Concurrent set partitioned by key ranges into SplayTree shards, every shard has its own lock.
+// Bounds of shards are read under shared lock of directory and changed only by rebalancing
+// under exclusive one. Ranks are prefix sums of sizes of shards (Fenwick tree of atomics)
+// plus at most two shard-local queries, so queries to different shards don't wait each other
+template<typename KeyT, class Cmp = std::less<KeyT>>
+class ShardedSplayTree final
+{
+public:
+    using key_type  = KeyT;
+    using size_type = std::size_t;
+    using tree_type = SplayTree<KeyT, Cmp>;
+
+private:
+    struct Shard
+    {
+        std::mutex mutex_;
+        tree_type tree_;
+    };
+
+    size_type capacity_;
+    size_type min_shard_size_;
+    std::unique_ptr<Shard[]> shards_;
+    // shard i holds keys in [bounds_[i - 1], bounds_[i]), there are active_ - 1 bounds
+    std::vector<key_type> bounds_ {};
+    size_type active_ = 1;
+    // Fenwick tree over sizes of shards, indexes from 1
+    std::unique_ptr<std::atomic<std::ptrdiff_t>[]> fenwick_;
+    std::atomic<size_type> size_ {0};
+
+    mutable std::shared_mutex directory_mutex_;
+    std::atomic<bool> rebalancing_ {false};
+
+    Cmp cmp {};
+
+//----------------------------------------=| Ctors start |=---------------------------------------------
+public:
+    // Shards are split from the first one when they grow to 2 * min_shard_size, when all of them are
+    // in use, shard larger than twice average one gives keys to lighter neighbour
+    explicit ShardedSplayTree(size_type shards = std::max(1u, std::thread::hardware_concurrency()),
+                              size_type min_shard_size = 1 << 12)
+    :capacity_ {shards}, min_shard_size_ {std::max<size_type>(1, min_shard_size)}
+    {
+        if (capacity_ == 0)
+            throw std::invalid_argument{"ShardedSplayTree: need at least one shard"};
+        shards_  = std::make_unique<Shard[]>(capacity_);
+        fenwick_ = std::make_unique<std::atomic<std::ptrdiff_t>[]>(capacity_ + 1);
+        // rebalancing doesn't allocate
+        bounds_.reserve(capacity_ - 1);
+    }
+
+    // keys are split in equal shards of balanced trees
+    template<std::input_iterator InpIt>
+    ShardedSplayTree(InpIt first, InpIt last, size_type shards = std::max(1u, std::thread::hardware_concurrency()),
+                     size_type min_shard_size = 1 << 12)
+    :ShardedSplayTree(shards, min_shard_size)
+    {
+        std::vector<key_type> keys(first, last);
+        std::sort(keys.begin(), keys.end(), cmp);
+        keys.erase(std::unique(keys.begin(), keys.end(), [this](const key_type& lhs, const key_type& rhs)
+                               {return !cmp(lhs, rhs);}), keys.end());
+
+        active_ = std::clamp<size_type>(keys.size() / min_shard_size_, 1, capacity_);
+        for (size_type i = 0; i < active_; i++)
+        {
+            auto shard_first = keys.begin() + keys.size() * i / active_;
+            auto shard_last  = keys.begin() + keys.size() * (i + 1) / active_;
+            shards_[i].tree_.build_from(shard_first, shard_last, 1);
+            if (i)
+                bounds_.push_back(*shard_first);
+        }
+        size_ = keys.size();
+        rebuild_sizes();
+    }
+
+    ShardedSplayTree(const ShardedSplayTree&) = delete;
+    ShardedSplayTree& operator=(const ShardedSplayTree&) = delete;
+//----------------------------------------=| Ctors end |=-----------------------------------------------
+
+//----------------------------------------=| Size`s funcs start |=--------------------------------------
+    size_type size() const noexcept {return size_.load();}
+
+    bool empty() const noexcept {return (size() == 0);}
+
+    size_type shards() const
+    {
+        std::shared_lock directory {directory_mutex_};
+        return active_;
+    }
+
+    std::vector<size_type> shard_sizes() const
+    {
+        std::shared_lock directory {directory_mutex_};
+        std::vector<size_type> sizes(active_);
+        for (size_type i = 0; i < active_; i++)
+        {
+            std::lock_guard lock {shards_[i].mutex_};
+            sizes[i] = shards_[i].tree_.size();
+        }
+        return sizes;
+    }
+//----------------------------------------=| Size`s funcs end |=----------------------------------------
+
+//----------------------------------------=| Modifiers start |=-----------------------------------------
+    bool insert(const key_type& key)
+    {
+        bool heavy = false;
+        {
+            std::shared_lock directory {directory_mutex_};
+            auto index = shard_of(key);
+            auto& shard = shards_[index];
+            std::lock_guard lock {shard.mutex_};
+
+            if (!shard.tree_.insert(key).second)
+                return false;
+            add_size(index, 1);
+            size_++;
+            heavy = is_heavy(shard.tree_.size());
+        }
+        if (heavy)
+            rebalance();
+        return true;
+    }
+
+    bool erase(const key_type& key)
+    {
+        std::shared_lock directory {directory_mutex_};
+        auto index = shard_of(key);
+        auto& shard = shards_[index];
+        std::lock_guard lock {shard.mutex_};
+
+        auto itr = shard.tree_.find(key);
+        if (itr == shard.tree_.end())
+            return false;
+        shard.tree_.erase(itr);
+        add_size(index, -1);
+        size_--;
+        return true;
+    }
+//----------------------------------------=| Modifiers end |=-------------------------------------------
+
+//----------------------------------------=| Queries start |=-------------------------------------------
+    // Sizes of other shards are read without their locks:
+    // answers are exact when there are no concurrent updates
+    bool contains(const key_type& key) const
+    {
+        std::shared_lock directory {directory_mutex_};
+        auto& shard = shards_[shard_of(key)];
+        std::lock_guard lock {shard.mutex_};
+        return shard.tree_.find(key) != shard.tree_.end();
+    }
+
+    size_type number_less_than(const key_type& key) const
+    {
+        std::shared_lock directory {directory_mutex_};
+        auto index = shard_of(key);
+        std::lock_guard lock {shards_[index].mutex_};
+        return prefix_size(index) + shards_[index].tree_.number_less_than(key);
+    }
+
+    size_type number_not_greater_than(const key_type& key) const
+    {
+        std::shared_lock directory {directory_mutex_};
+        auto index = shard_of(key);
+        std::lock_guard lock {shards_[index].mutex_};
+        return prefix_size(index) + shards_[index].tree_.number_not_greater_than(key);
+    }
+
+    // number of keys in [first, last], shards of bounds are locked one by one
+    size_type count_in_range(const key_type& first, const key_type& last) const
+    {
+        if (cmp(last, first))
+            return 0;
+
+        std::shared_lock directory {directory_mutex_};
+        auto first_index = shard_of(first), last_index = shard_of(last);
+        if (first_index == last_index)
+        {
+            auto& tree = shards_[first_index].tree_;
+            std::lock_guard lock {shards_[first_index].mutex_};
+            return tree.number_not_greater_than(last) - tree.number_less_than(first);
+        }
+
+        size_type count = prefix_size(last_index) - prefix_size(first_index + 1);
+        {
+            auto& tree = shards_[first_index].tree_;
+            std::lock_guard lock {shards_[first_index].mutex_};
+            count += tree.size() - tree.number_less_than(first);
+        }
+        {
+            std::lock_guard lock {shards_[last_index].mutex_};
+            count += shards_[last_index].tree_.number_not_greater_than(last);
+        }
+        return count;
+    }
+//----------------------------------------=| Queries end |=---------------------------------------------
+
+//----------------------------------------=| Directory start |=-----------------------------------------
+private:
+    size_type shard_of(const key_type& key) const
+    {
+        return std::upper_bound(bounds_.begin(), bounds_.end(), key, cmp) - bounds_.begin();
+    }
+
+    void add_size(size_type shard, std::ptrdiff_t delta) noexcept
+    {
+        for (auto i = shard + 1; i <= capacity_; i += i & (~i + 1))
+            fenwick_[i].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    // total size of shards [0, shard)
+    size_type prefix_size(size_type shard) const noexcept
+    {
+        std::ptrdiff_t size = 0;
+        for (auto i = shard; i > 0; i -= i & (~i + 1))
+            size += fenwick_[i].load(std::memory_order_relaxed);
+        return static_cast<size_type>(size);
+    }
+
+    // under exclusive lock
+    void rebuild_sizes() noexcept
+    {
+        for (size_type i = 0; i <= capacity_; i++)
+            fenwick_[i].store(0, std::memory_order_relaxed);
+        for (size_type i = 0; i < active_; i++)
+            add_size(i, static_cast<std::ptrdiff_t>(shards_[i].tree_.size()));
+    }
+
+    bool is_heavy(size_type shard_size) const noexcept
+    {
+        if (shard_size < 2 * min_shard_size_)
+            return false;
+        return active_ < capacity_ || shard_size > 2 * size_.load() / active_ + min_shard_size_;
+    }
+
+    void rebalance()
+    {
+        // one thread rebalances, others go on
+        if (rebalancing_.exchange(true))
+            return;
+        {
+            std::unique_lock directory {directory_mutex_};
+            size_type heaviest = 0;
+            for (size_type i = 1; i < active_; i++)
+                if (shards_[i].tree_.size() > shards_[heaviest].tree_.size())
+                    heaviest = i;
+
+            if (is_heavy(shards_[heaviest].tree_.size()))
+            {
+                if (active_ < capacity_)
+                    split_shard(heaviest);
+                else
+                    move_to_neighbour(heaviest);
+            }
+        }
+        rebalancing_ = false;
+    }
+
+    // upper half of shard becomes new shard after it
+    void split_shard(size_type index) noexcept
+    {
+        auto& tree = shards_[index].tree_;
+        auto median = tree.kth_smallest(tree.size() / 2);
+        auto upper = tree.split_off(median);
+
+        for (auto i = active_; i > index + 1; i--)
+            shards_[i].tree_ = std::move(shards_[i - 1].tree_);
+        shards_[index + 1].tree_ = std::move(upper);
+        bounds_.insert(bounds_.begin() + index, median);
+        active_++;
+        rebuild_sizes();
+    }
+
+    // half of difference of sizes goes to lighter neighbour, nodes are moved by split and join
+    void move_to_neighbour(size_type index) noexcept
+    {
+        auto& tree = shards_[index].tree_;
+        auto neighbour = index;
+        if (index > 0)
+            neighbour = index - 1;
+        if (index + 1 < active_ && (neighbour == index || shards_[index + 1].tree_.size() < shards_[neighbour].tree_.size()))
+            neighbour = index + 1;
+        if (neighbour == index || shards_[neighbour].tree_.size() >= tree.size())
+            return;
+
+        auto moved = (tree.size() - shards_[neighbour].tree_.size()) / 2;
+        if (moved == 0)
+            return;
+
+        if (neighbour > index)
+        {
+            auto bound = tree.kth_smallest(tree.size() - moved);
+            auto upper = tree.split_off(bound);
+            shards_[neighbour].tree_.merge(upper);
+            bounds_[index] = bound;
+        }
+        else
+        {
+            auto bound = tree.kth_smallest(moved);
+            auto upper = tree.split_off(bound);
+            shards_[neighbour].tree_.merge(tree);
+            tree = std::move(upper);
+            bounds_[neighbour] = bound;
+        }
+        add_size(index, -static_cast<std::ptrdiff_t>(moved));
+        add_size(neighbour, static_cast<std::ptrdiff_t>(moved));
+    }
+//----------------------------------------=| Directory end |=-------------------------------------------
+}; // class ShardedSplayTree
+} // namespace Container
@@ -1,6 +1,16 @@
 #pragma once
 #include "search_tree.hpp"
+#include "elias_fano_set.hpp"
+#include "frozen_set.hpp"
+#include "learned_set.hpp"
+#include <bit>
 #include <cmath>
+#include <future>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <vector>
 
 namespace Container
 {
@@ -62,6 +72,13 @@ private:
 
     using base::key_less;
     using base::key_equal;
+    using base::count_descent;
+
+    using base::stats_;
+    using base::parallel_grain;
+
+    // 0 - rebalance is off
+    double rebalance_factor_ = 0;
 
 public:
     SplayTree() = default;
@@ -106,8 +123,21 @@ public:
             return end();
         auto itr_next = std::next(itr);
         auto node = itr.base();
-        splay(base::erase_from_tree(node));
+
+        // lowest node which loses one node in subtree: parent of node or of its successor
+        auto lowest = cast(node->parent_);
+        if (node->left_ && node->right_)
+        {
+            auto successor = cast(detail::find_min(node->right_));
+            lowest = (successor->parent_ == node) ? successor : cast(successor->parent_);
+        }
+
+        auto replacement = base::erase_from_tree(node);
+        for (; lowest; lowest = cast(lowest->parent_))
+            lowest->calc_size();
+        splay(replacement);
         delete node;
+        stats_.free();
         return itr_next;
     }
 
@@ -126,9 +156,9 @@ public:
     
     size_type number_less_than(const key_type& key) const
     {
-        size_type number = 0;
+        size_type number = 0, depth = 0;
         node_ptr current = root_, splay_node = current;
-        while (current)
+        for (; current; depth++)
         {
             splay_node = current;
             if (key_less(current->key_, key))
@@ -141,15 +171,16 @@ public:
             else
                 current = cast(current->left_);
         }
+        count_descent(depth);
         splay(splay_node);
         return number;
     }
 
     size_type number_not_greater_than(const key_type& key) const
     {
-        size_type number = 0;
+        size_type number = 0, depth = 0;
         node_ptr current = root_, splay_node = current;
-        while (current)
+        for (; current; depth++)
         {
             splay_node = current;
             if (key_less(current->key_, key) || key_equal(current->key_, key))
@@ -162,10 +193,88 @@ public:
             else
                 current = cast(current->left_);
         }
+        count_descent(depth);
         splay(splay_node);
         return number;
     }
 
+    // Batch lookups descend interleaved without splaying (see SearchTree::find_batch), with splay_after
+    // found nodes are splayed in order of keys after all descents, as single lookups would do
+    template<std::random_access_iterator RandIt>
+    std::vector<ConstIterator> find_batch(RandIt first, RandIt last, bool splay_after = false) const
+    {
+        auto nodes = base::find_batch_ptr(first, last);
+        if (splay_after)
+            splay_all(nodes);
+        return base::to_iterators(nodes);
+    }
+
+    template<std::random_access_iterator RandIt>
+    std::vector<ConstIterator> lower_bound_batch(RandIt first, RandIt last, bool splay_after = false) const
+    {
+        auto nodes = base::lower_bound_batch_ptr(first, last);
+        if (splay_after)
+            splay_all(nodes);
+        return base::to_iterators(nodes);
+    }
+
+    // number_less_than for every key of [first, last)
+    template<std::random_access_iterator RandIt>
+    std::vector<size_type> rank_batch(RandIt first, RandIt last, bool splay_after = false) const
+    {
+        std::vector<size_type> ranks(last - first, 0);
+        std::vector<node_ptr> last_nodes(ranks.size(), nullptr);
+        base::interleave(ranks.size(), [&](size_type index, node_ptr node) -> node_ptr
+        {
+            last_nodes[index] = node;
+            if (!key_less(node->key_, first[index]))
+                return cast(node->left_);
+            ranks[index] += (node->left_ ? cast(node->left_)->size_ : 0) + 1;
+            return cast(node->right_);
+        });
+        if (splay_after)
+            splay_all(last_nodes);
+        return ranks;
+    }
+
+    // Sorted batches are answered by one descent (see SearchTree::find_sorted_batch), keys are sorted by comparator
+    template<std::random_access_iterator RandIt>
+    std::vector<ConstIterator> find_sorted_batch(RandIt first, RandIt last, bool splay_after = false) const
+    {
+        auto nodes = base::find_sorted_batch_ptr(first, last);
+        if (splay_after)
+            splay_all(nodes);
+        return base::to_iterators(nodes);
+    }
+
+    // number_less_than for every key of sorted [first, last)
+    template<std::random_access_iterator RandIt>
+    std::vector<size_type> rank_sorted_batch(RandIt first, RandIt last, bool splay_after = false) const
+    {
+        std::vector<size_type> ranks(last - first, 0);
+        std::vector<node_ptr> last_nodes(splay_after ? ranks.size() : 0, nullptr);
+        auto answer = [&](node_ptr node, size_type equal_first, size_type equal_last, size_type rank)
+        {
+            std::fill(ranks.begin() + equal_first, ranks.begin() + equal_last, rank);
+            if (splay_after)
+                std::fill(last_nodes.begin() + equal_first, last_nodes.begin() + equal_last, node);
+        };
+        base::sorted_descent(first, ranks.size(),
+                             [](node_ptr node) {return node->left_ ? cast(node->left_)->size_ : 0;},
+                             answer, answer);
+        if (splay_after)
+            splay_all(last_nodes);
+        return ranks;
+    }
+
+    // index < size()
+    const key_type& kth_smallest(size_type index) const noexcept
+    {
+        auto node = select(root_, index);
+        splay(node);
+        return node->key_;
+    }
+
     size_type distance(ConstIterator first, ConstIterator last) const
     {
         size_type dist = 0;
@@ -177,6 +286,161 @@ public:
         }
         return dist;
     }
+
+    // Immutable copy in O(n) for phases without updates: queries don't chase pointers and don't splay
+    FrozenSet<KeyT, Cmp> freeze() const
+    {
+        return FrozenSet<KeyT, Cmp>(this->cbegin(), this->cend(), base::cmp);
+    }
+
+    // Compressed immutable copy of integer keys (EliasFanoSet), about 2 + log2(range / size) bits per key
+    auto compress() const requires elias_fano_encodable<KeyT, Cmp>
+    {
+        return EliasFanoSet<KeyT>(this->cbegin(), this->cend());
+    }
+
+    // Immutable copy of numeric keys with piecewise linear model of their positions (LearnedSet) in O(n)
+    auto learn(size_type epsilon = 32) const requires learned_indexable<KeyT, Cmp>
+    {
+        return LearnedSet<KeyT>(this->cbegin(), this->cend(), epsilon);
+    }
+
+    // Opt-in guard against degenerate shapes (e.g. path after sorted inserts). When node to splay is deeper
+    // than factor * log2(size), the smallest subtree on its path, rebuild of which brings node under this bound,
+    // is rebuilt balanced in linear time. Factor should be at least 1, about 3 keeps rebuilds rare; 0 turns guard off
+    void set_rebalance_factor(double factor)
+    {
+        if (factor != 0 && !(factor >= 1))
+            throw std::invalid_argument{"SplayTree: rebalance factor should be 0 or at least 1"};
+        rebalance_factor_ = factor;
+    }
+
+    double rebalance_factor() const noexcept {return rebalance_factor_;}
+
+    // Estimates shape by descents to samples uniformly random nodes (by rank) in O(samples * depth).
+    // Depths are sampled depths of nodes, potential is size * average log2(size of subtree)
+    TreeShape sample_shape(size_type samples, std::uint64_t seed = std::random_device{}()) const
+    {
+        TreeShape shape {};
+        shape.size = size_;
+        if (!root_ || !samples)
+            return shape;
+
+        std::mt19937_64 rand {seed};
+        std::uniform_int_distribution<size_type> rank_dist {0, size_ - 1};
+        double depth_sum = 0, log_size_sum = 0;
+
+        for (size_type i = 0; i < samples; i++)
+        {
+            auto rank  = rank_dist(rand);
+            auto node  = root_;
+            size_type depth = 0;
+            for (;; depth++)
+            {
+                size_type left_size = node->left_ ? cast(node->left_)->size_ : 0;
+                if (rank < left_size)
+                    node = cast(node->left_);
+                else if (rank == left_size)
+                    break;
+                else
+                {
+                    rank -= left_size + 1;
+                    node  = cast(node->right_);
+                }
+            }
+
+            if (shape.depth_histogram.size() <= depth)
+                shape.depth_histogram.resize(depth + 1);
+            shape.depth_histogram[depth]++;
+            depth_sum    += depth;
+            log_size_sum += std::log2(static_cast<double>(node->size_));
+        }
+
+        shape.samples = samples;
+        shape.height  = shape.depth_histogram.size();
+        shape.average_depth = depth_sum / samples;
+        shape.potential = size_ * log_size_sum / samples;
+        return shape;
+    }
+
+    // Moves nodes of other with keys not found in this tree without allocations, like std::set::merge.
+    // Trees with disjoint ranges are joined in O(log n), otherwise nodes are moved by split/join union
+    // and nodes with duplicate keys are left in other
+    void merge(SplayTree& other)
+    {
+        if (this == &other || other.empty())
+            return;
+
+        if (this->empty())
+        {
+            root_ = other.root_;
+            size_ = other.size_;
+            base::min_ = other.min_;
+            max_ = other.max_;
+        }
+        else if (key_less(max_->key_, other.min_->key_))
+        {
+            // maximum has no right son after splay
+            splay(max_);
+            root_->right_ = other.root_;
+            other.root_->parent_ = root_;
+            root_->calc_size();
+            size_ = root_->size_;
+            max_  = other.max_;
+        }
+        else if (key_less(other.max_->key_, base::min_->key_))
+        {
+            splay(base::min_);
+            root_->left_ = other.root_;
+            other.root_->parent_ = root_;
+            root_->calc_size();
+            size_ = root_->size_;
+            base::min_ = other.min_;
+        }
+        else
+        {
+            NodeList duplicates {};
+            adopt(combine<SetOperation::Merge>(root_, other.root_, base::cmp, 1, duplicates));
+            other.adopt(link_list(duplicates.head, duplicates.size));
+            return;
+        }
+        other.release();
+    }
+
+    // Moves keys not less than key to returned tree in O(depth) without allocations
+    SplayTree split_off(const key_type& key)
+    {
+        auto [left, equal, right] = split(root_, key, base::cmp);
+        if (equal)
+            right = link(nullptr, equal, right);
+
+        SplayTree greater {};
+        greater.rebalance_factor_ = rebalance_factor_;
+        greater.adopt(right);
+        adopt(left);
+        return greater;
+    }
+
+    // Set algebra by split/join divide and conquer. Nodes of arguments are reused (pass trees with std::move
+    // to avoid copies), nodes of dropped keys are freed. Both trees are split by median of larger one, so
+    // recursion is O(log(n + m)) deep for trees of any shape and result is at most that higher than arguments.
+    // Halves of large subproblems are processed by up to threads threads
+    friend SplayTree set_union(SplayTree lhs, SplayTree rhs, unsigned threads = 1)
+    {
+        return set_operation<SetOperation::Union>(lhs, rhs, threads);
+    }
+
+    friend SplayTree set_intersection(SplayTree lhs, SplayTree rhs, unsigned threads = 1)
+    {
+        return set_operation<SetOperation::Intersection>(lhs, rhs, threads);
+    }
+
+    // keys of lhs not found in rhs
+    friend SplayTree set_difference(SplayTree lhs, SplayTree rhs, unsigned threads = 1)
+    {
+        return set_operation<SetOperation::Difference>(lhs, rhs, threads);
+    }
+
 private:
     std::pair<ConstIterator, bool> insert_impl(key_type&& key)
     {
@@ -186,11 +450,289 @@ private:
         return ret;
     }
 
+    // Merge is union which leaves nodes with keys of lhs in rhs
+    enum class SetOperation {Union, Intersection, Difference, Merge};
+
+    // sorted nodes linked by right_
+    struct NodeList
+    {
+        node_ptr head = nullptr, tail = nullptr;
+        size_type size = 0;
+
+        void push_back(node_ptr node) noexcept
+        {
+            node->left_ = node->right_ = nullptr;
+            if (tail)
+                tail->right_ = node;
+            else
+                head = node;
+            tail = node;
+            size++;
+        }
+    };
+
+    template<SetOperation Op>
+    static SplayTree set_operation(SplayTree& lhs, SplayTree& rhs, unsigned threads)
+    {
+        NodeList duplicates {};
+        auto root = combine<Op>(lhs.root_, rhs.root_, lhs.cmp, threads, duplicates);
+        lhs.release();
+        rhs.release();
+
+        SplayTree result {};
+        result.adopt(root);
+        return result;
+    }
+
+    // forget nodes, they belong to another tree now
+    void release() noexcept
+    {
+        root_ = nullptr;
+        size_ = 0;
+        base::min_ = base::max_ = nullptr;
+    }
+
+    void adopt(node_ptr root) noexcept
+    {
+        root_ = root;
+        if (root_)
+            root_->parent_ = nullptr;
+        size_ = root_ ? root_->size_ : 0;
+        base::min_ = cast(detail::find_min(root_));
+        base::max_ = cast(detail::find_max(root_));
+    }
+
+    // Parent of returned root is not set. Duplicates are collected only by sequential merge
+    template<SetOperation Op>
+    static node_ptr combine(node_ptr lhs, node_ptr rhs, const Cmp& cmp, unsigned threads, NodeList& duplicates)
+    {
+        if (!lhs || !rhs)
+        {
+            if constexpr (Op == SetOperation::Union || Op == SetOperation::Merge)
+                return lhs ? lhs : rhs;
+            if constexpr (Op == SetOperation::Intersection)
+                delete_subtree(lhs);
+            delete_subtree(rhs);
+            return (Op == SetOperation::Difference) ? lhs : nullptr;
+        }
+
+        auto total = lhs->size_ + rhs->size_;
+        auto splitter = (lhs->size_ >= rhs->size_) ? select(lhs, lhs->size_ / 2) : select(rhs, rhs->size_ / 2);
+        auto [lhs_left, lhs_equal, lhs_right] = split(lhs, splitter->key_, cmp);
+        auto [rhs_left, rhs_equal, rhs_right] = split(rhs, splitter->key_, cmp);
+
+        node_ptr middle = nullptr;
+        if (Op == SetOperation::Union || Op == SetOperation::Merge)
+            middle = lhs_equal ? lhs_equal : rhs_equal;
+        else if (Op == SetOperation::Intersection && rhs_equal)
+            middle = lhs_equal;
+        else if (Op == SetOperation::Difference && !rhs_equal)
+            middle = lhs_equal;
+        auto duplicate = (Op == SetOperation::Merge && lhs_equal) ? rhs_equal : nullptr;
+
+        node_ptr left = nullptr, right = nullptr;
+        std::future<node_ptr> left_future {};
+        if (Op != SetOperation::Merge && threads > 1 && total >= parallel_grain)
+            try
+            {
+                left_future = std::async(std::launch::async, [=, &cmp, &duplicates]
+                                         {return combine<Op>(lhs_left, rhs_left, cmp, threads / 2, duplicates);});
+            }
+            catch (const std::system_error&)
+            {
+                // no more threads, left half is processed by this one
+            }
+        if (!left_future.valid())
+            left = combine<Op>(lhs_left, rhs_left, cmp, threads / 2, duplicates);
+
+        // duplicates are collected in order: left half, middle, right half
+        if (duplicate)
+            duplicates.push_back(duplicate);
+        else if (rhs_equal != middle)
+            delete rhs_equal;
+        if (lhs_equal != middle)
+            delete lhs_equal;
+
+        right = combine<Op>(lhs_right, rhs_right, cmp, threads - threads / 2, duplicates);
+        if (left_future.valid())
+            left = left_future.get();
+        return middle ? link(left, middle, right) : join(left, right);
+    }
+
+    // balanced tree of first count nodes of sorted list, list is advanced
+    static node_ptr link_list(node_ptr& list, size_type count) noexcept
+    {
+        if (!count)
+            return nullptr;
+        auto left   = link_list(list, count / 2);
+        auto middle = list;
+        list = cast(list->right_);
+        auto right  = link_list(list, count - count / 2 - 1);
+        return link(left, middle, right);
+    }
+
+    // node with given number of less keys in subtree
+    static node_ptr select(node_ptr root, size_type rank) noexcept
+    {
+        for (;;)
+        {
+            size_type left_size = root->left_ ? cast(root->left_)->size_ : 0;
+            if (rank < left_size)
+                root = cast(root->left_);
+            else if (rank == left_size)
+                return root;
+            else
+            {
+                rank -= left_size + 1;
+                root = cast(root->right_);
+            }
+        }
+    }
+
+    // Top-down split of subtree into keys less than key, node with key (detached) and greater keys.
+    // Nodes of search path are hooked to rightmost place of left tree or leftmost place of right tree
+    static std::tuple<node_ptr, node_ptr, node_ptr> split(node_ptr root, const key_type& key, const Cmp& cmp) noexcept
+    {
+        using base_node_ptr = detail::Node<KeyT>*;
+        base_node_ptr left = nullptr, right = nullptr;
+        base_node_ptr *left_hook = &left, *right_hook = &right;
+        node_ptr left_last = nullptr, right_last = nullptr, equal = nullptr;
+
+        while (root)
+            if (cmp(root->key_, key))
+            {
+                *left_hook = root;
+                root->parent_ = left_last;
+                left_last = root;
+                left_hook = &root->right_;
+                root = cast(root->right_);
+            }
+            else if (cmp(key, root->key_))
+            {
+                *right_hook = root;
+                root->parent_ = right_last;
+                right_last = root;
+                right_hook = &root->left_;
+                root = cast(root->left_);
+            }
+            else
+            {
+                equal = root;
+                break;
+            }
+
+        *left_hook  = equal ? equal->left_  : nullptr;
+        *right_hook = equal ? equal->right_ : nullptr;
+        if (*left_hook)
+            (*left_hook)->parent_ = left_last;
+        if (*right_hook)
+            (*right_hook)->parent_ = right_last;
+        if (equal)
+        {
+            equal->left_ = equal->right_ = nullptr;
+            equal->size_ = 1;
+        }
+
+        // hooked nodes lost or got subtrees, sizes are fixed bottom-up
+        for (; left_last; left_last = cast(left_last->parent_))
+            left_last->calc_size();
+        for (; right_last; right_last = cast(right_last->parent_))
+            right_last->calc_size();
+        return {cast(left), equal, cast(right)};
+    }
+
+    static node_ptr link(node_ptr left, node_ptr middle, node_ptr right) noexcept
+    {
+        middle->left_  = left;
+        middle->right_ = right;
+        if (left)
+            left->parent_ = middle;
+        if (right)
+            right->parent_ = middle;
+        middle->calc_size();
+        return middle;
+    }
+
+    // all keys of left are less than keys of right, middle is taken from larger tree
+    static node_ptr join(node_ptr left, node_ptr right) noexcept
+    {
+        if (!left || !right)
+            return left ? left : right;
+
+        if (left->size_ >= right->size_)
+        {
+            auto middle = cast(detail::find_max(left));
+            if (middle == left)
+                left = cast(left->left_);
+            else
+            {
+                auto parent = cast(middle->parent_);
+                parent->right_ = middle->left_;
+                if (middle->left_)
+                    middle->left_->parent_ = parent;
+                for (;; parent = cast(parent->parent_))
+                {
+                    parent->calc_size();
+                    if (parent == left)
+                        break;
+                }
+            }
+            return link(left, middle, right);
+        }
+
+        auto middle = cast(detail::find_min(right));
+        if (middle == right)
+            right = cast(right->right_);
+        else
+        {
+            auto parent = cast(middle->parent_);
+            parent->left_ = middle->right_;
+            if (middle->right_)
+                middle->right_->parent_ = parent;
+            for (;; parent = cast(parent->parent_))
+            {
+                parent->calc_size();
+                if (parent == right)
+                    break;
+            }
+        }
+        return link(left, middle, right);
+    }
+
+    // rotates left sons up to free nodes without stack and parent pointers
+    static void delete_subtree(node_ptr node) noexcept
+    {
+        while (node)
+            if (node->left_)
+            {
+                auto left = cast(node->left_);
+                node->left_  = left->right_;
+                left->right_ = node;
+                node = left;
+            }
+            else
+            {
+                auto right = cast(node->right_);
+                delete node;
+                node = right;
+            }
+    }
+
+    void splay_all(const std::vector<node_ptr>& nodes) const noexcept
+    {
+        for (auto node: nodes)
+            splay(node);
+    }
+
     void splay(node_ptr node) const noexcept
     {
         if (!node)
             return;
 
+        if (rebalance_factor_ != 0)
+            rebalance(node);
+
+        stats_.splay();
         while (node != root_)
             // zig case
             // pic for node->is_left_son()
@@ -204,10 +746,13 @@ private:
             |* _______________________________________                        
             \*/
             if (node->parent_ == root_)
+            {
+                stats_.zig();
                 if (node->is_left_son())
                     right_rotate(cast(node->parent_));
                 else
                     left_rotate(cast(node->parent_));
+            }
             else
             // zig-zig case
             // pic for case in first if, else case is symmetric
@@ -225,11 +770,13 @@ private:
             \*/
                 if (node->is_left_son() && node->parent_->is_left_son())
                 {
+                    stats_.zig_zig();
                     right_rotate(cast(node->parent_->parent_));
                     right_rotate(cast(node->parent_));
                 }
                 else if (node->is_right_son() && node->parent_->is_right_son())
                 {
+                    stats_.zig_zig();
                     left_rotate(cast(node->parent_->parent_));
                     left_rotate(cast(node->parent_));
                 }
@@ -248,16 +795,64 @@ private:
             \*/
                 else if (node->is_right_son() && node->parent_->is_left_son())
                 {
+                    stats_.zig_zag();
                     left_rotate(cast(node->parent_));
                     right_rotate(cast(node->parent_));
                 }
                 else // if (node->is_left_son() && node->parent_->is_right_son())
                 {
+                    stats_.zig_zag();
                     right_rotate(cast(node->parent_));
                     left_rotate(cast(node->parent_));
                 }
     }
 
+    void rebalance(node_ptr node) const noexcept
+    {
+        auto limit = rebalance_factor_ * std::log2(static_cast<double>(size_));
+        size_type depth = 0;
+        for (auto current = node; current != root_; current = cast(current->parent_))
+            depth++;
+        if (depth <= limit)
+            return;
+
+        // balanced subtree of n nodes has floor(log2(n)) levels under its root
+        auto subtree = node;
+        while (subtree != root_ && depth + std::bit_width(subtree->size_) - 1 > limit)
+        {
+            subtree = cast(subtree->parent_);
+            depth--;
+        }
+
+        try
+        {
+            rebuild(subtree);
+        }
+        catch (const std::bad_alloc&)
+        {
+            // tree is not changed, node is just splayed from its depth
+        }
+    }
+
+    void rebuild(node_ptr subtree) const
+    {
+        std::vector<node_ptr> nodes {};
+        nodes.reserve(subtree->size_);
+        base::collect_nodes(subtree, nodes);
+
+        auto parent = cast(subtree->parent_);
+        auto is_left_son = parent && subtree->is_left_son();
+        auto new_subtree = base::link_balanced(nodes.data(), nodes.data() + nodes.size(), parent);
+
+        if (!parent)
+            root_ = new_subtree;
+        else if (is_left_son)
+            parent->left_ = new_subtree;
+        else
+            parent->right_ = new_subtree;
+        stats_.rebuild(nodes.size());
+    }
+
     /*\_________________________________________________
     |*                                                  |
     |*        x                             y           |
@@ -305,6 +900,7 @@ private:
 
         x->calc_size();
         y->calc_size();
+        stats_.rotation();
     }
 
     /*\_________________________________________________
@@ -342,6 +938,7 @@ private:
 
         x->calc_size();
         y->calc_size();
+        stats_.rotation();
     }
 };
 } // namespace Container
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Container
+{
+
+// Snapshot of counters of hot paths. Counters are collected only if SPLAY_TREE_STATS
+// is defined (for whole program, it changes layout of trees), otherwise all are zeros
+struct TreeStats
+{
+    std::size_t comparisons = 0;       // comparator invocations
+    std::size_t descents = 0;          // descents from root: find, bounds, rank, insert
+    std::size_t descent_depth = 0;     // sum of depths of all descents: depth of last visited node, root is 0
+    std::size_t max_descent_depth = 0;
+    double recent_descent_depth = 0;   // exponential moving average, recent descents weigh more
+    std::size_t splays = 0;
+    std::size_t rotations = 0;
+    std::size_t zigs = 0, zig_zigs = 0, zig_zags = 0;
+    std::size_t allocations = 0, frees = 0;
+    std::size_t rebuilds = 0, rebuilt_nodes = 0;  // depth-triggered rebalances of subtrees
+
+    double average_descent_depth() const noexcept {return descents ? static_cast<double>(descent_depth) / descents : 0.0;}
+    double rotations_per_splay()   const noexcept {return splays ? static_cast<double>(rotations) / splays : 0.0;}
+};
+
+// Shape of tree: exact (samples == 0) or estimated by sampled descents
+struct TreeShape
+{
+    std::size_t size = 0;
+    std::size_t height = 0;                       // number of levels, lower bound if sampled
+    std::vector<std::size_t> depth_histogram {};  // number of nodes (or samples) on every depth, root depth is 0
+    double average_depth = 0;
+    double potential = 0;                         // Sleator-Tarjan potential: sum of log2(size of subtree)
+    std::size_t samples = 0;
+
+    // height over height of balanced tree, grows when tree degenerates
+    double height_ratio() const noexcept {return size ? height / std::log2(size + 1.0) : 0.0;}
+};
+
+namespace detail
+{
+#ifdef SPLAY_TREE_STATS
+inline constexpr bool stats_enabled = true;
+#else
+inline constexpr bool stats_enabled = false;
+#endif
+
+template<bool Enabled = stats_enabled>
+class StatsCounter
+{
+    TreeStats stats_ {};
+
+    // weight of last descent in moving average of depth
+    static constexpr double recent_weight = 1.0 / 64;
+public:
+    void comparison(std::size_t number = 1) noexcept {stats_.comparisons += number;}
+
+    void descent(std::size_t depth) noexcept
+    {
+        stats_.descents++;
+        stats_.descent_depth += depth;
+        stats_.max_descent_depth = std::max(stats_.max_descent_depth, depth);
+        stats_.recent_descent_depth += recent_weight * (depth - stats_.recent_descent_depth);
+    }
+
+    void splay()     noexcept {stats_.splays++;}
+    void rotation()  noexcept {stats_.rotations++;}
+    void zig()       noexcept {stats_.zigs++;}
+    void zig_zig()   noexcept {stats_.zig_zigs++;}
+    void zig_zag()   noexcept {stats_.zig_zags++;}
+    void allocation(std::size_t number = 1) noexcept {stats_.allocations += number;}
+    void free(std::size_t number = 1) noexcept {stats_.frees += number;}
+
+    void rebuild(std::size_t nodes) noexcept
+    {
+        stats_.rebuilds++;
+        stats_.rebuilt_nodes += nodes;
+    }
+
+    TreeStats snapshot() const noexcept {return stats_;}
+    void reset() noexcept {stats_ = TreeStats{};}
+};
+
+// all calls are empty and member of tree takes no space
+template<>
+class StatsCounter<false>
+{
+public:
+    void comparison(std::size_t = 1) noexcept {}
+    void descent(std::size_t) noexcept {}
+    void splay()      noexcept {}
+    void rotation()   noexcept {}
+    void zig()        noexcept {}
+    void zig_zig()    noexcept {}
+    void zig_zag()    noexcept {}
+    void allocation(std::size_t = 1) noexcept {}
+    void free(std::size_t = 1) noexcept {}
+    void rebuild(std::size_t) noexcept {}
+
+    TreeStats snapshot() const noexcept {return TreeStats{};}
+    void reset() noexcept {}
+};
+} // namespace detail
+} // namespace Container
@@ -0,0 +1,216 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "splay_tree.hpp"
+#include "../end-to-end/boost-set/include/boost_set.hpp"
+#include "task_driver.hpp"
+#include "perf_counters.hpp"
+
+namespace
+{
+
+// workload parsed once and replayed to every run of task engine
+class MemoryInput final
+{
+    const std::vector<std::int64_t>& values_;
+    std::size_t pos_ = 0;
+public:
+    explicit MemoryInput(const std::vector<std::int64_t>& values): values_ {values} {}
+
+    template<std::integral T>
+    bool read(T& value) noexcept
+    {
+        if (pos_ == values_.size())
+            return false;
+        value = static_cast<T>(values_[pos_++]);
+        return true;
+    }
+};
+
+// answers are not printed, only hashed to check that both trees agree
+class ChecksumOutput final
+{
+    std::uint64_t hash_ = 14695981039346656037ULL;
+public:
+    template<std::integral T>
+    void write(T value) noexcept
+    {
+        hash_ = (hash_ ^ static_cast<std::uint64_t>(value)) * 1099511628211ULL;
+    }
+    void write(char) noexcept {}
+    void flush() noexcept {}
+
+    std::uint64_t hash() const noexcept {return hash_;}
+};
+
+template<typename Input>
+std::vector<std::int64_t> load(Input& input)
+{
+    std::vector<std::int64_t> values {};
+    std::int64_t value = 0;
+    while (input.read(value))
+        values.push_back(value);
+    return values;
+}
+
+// two-sided 95% quantiles of Student's distribution for 1..30 degrees of freedom
+double student_t95(std::size_t df) noexcept
+{
+    constexpr double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    return (df == 0) ? 0.0 : (df <= 30) ? table[df - 1] : 1.96;
+}
+
+struct Stat
+{
+    double mean_ = 0, ci_ = 0;
+};
+
+Stat statistics(const std::vector<double>& samples)
+{
+    Stat stat {};
+    if (samples.empty())
+        return stat;
+    for (auto x: samples)
+        stat.mean_ += x;
+    stat.mean_ /= samples.size();
+    if (samples.size() < 2)
+        return stat;
+
+    double var = 0;
+    for (auto x: samples)
+        var += (x - stat.mean_) * (x - stat.mean_);
+    var /= samples.size() - 1;
+    stat.ci_ = student_t95(samples.size() - 1) * std::sqrt(var / samples.size());
+    return stat;
+}
+
+// samples of every metric per operation (key insertion or request)
+struct Measurement
+{
+    std::vector<double> time_ {};
+    std::array<std::vector<double>, Perf::num_of_events> events_ {};
+    std::uint64_t hash_ = 0;
+};
+
+template<typename KeyT, template<typename...> class Tree>
+Measurement measure(const std::vector<std::int64_t>& values, std::size_t runs, bool mixed)
+{
+    std::vector<std::unique_ptr<Perf::Counter>> counters {};
+    for (auto& desc: Perf::events)
+        counters.push_back(std::make_unique<Perf::Counter>(desc));
+
+    // number of keys, keys, number of requests (operations), pairs of bounds (operations)
+    auto num_of_keys = static_cast<std::size_t>(values.at(0));
+    auto num_of_reqs = static_cast<std::size_t>(values.at(num_of_keys + 1));
+    double ops = num_of_keys + num_of_reqs;
+
+    Measurement result {};
+    // first run warms up caches and allocator, it is not measured
+    for (std::size_t run = 0; run <= runs; run++)
+    {
+        MemoryInput input {values};
+        ChecksumOutput output {};
+
+        for (auto& counter: counters)
+            counter->start();
+        auto start = std::chrono::steady_clock::now();
+        Task::run<KeyT, Tree>(input, output, Task::Options{.mixed = mixed});
+        auto finish = std::chrono::steady_clock::now();
+        for (auto& counter: counters)
+            counter->stop();
+
+        result.hash_ = output.hash();
+        if (run == 0)
+            continue;
+
+        result.time_.push_back(std::chrono::duration<double, std::nano>(finish - start).count() / ops);
+        for (std::size_t i = 0; i < counters.size(); i++)
+            if (auto value = counters[i]->value())
+                result.events_[i].push_back(*value / ops);
+    }
+    return result;
+}
+
+void print_row(std::string_view metric, const std::vector<double>& splay, const std::vector<double>& boost)
+{
+    auto print = [](const std::vector<double>& samples)
+    {
+        if (samples.empty())
+        {
+            std::printf("  %24s", "n/a");
+            return;
+        }
+        auto [mean, ci] = statistics(samples);
+        std::printf("  %12.3f +- %-8.3f", mean, ci);
+    };
+    std::printf("%-16s", metric.data());
+    print(splay);
+    print(boost);
+    std::printf("\n");
+}
+
+template<typename KeyT>
+int compare(const std::vector<std::int64_t>& values, std::size_t runs, bool mixed)
+{
+    auto splay = measure<KeyT, Container::SplayTree>(values, runs, mixed);
+    auto boost = measure<KeyT, Container::BoostSet>(values, runs, mixed);
+
+    std::printf("%-16s  %24s  %24s\n", "per operation", "SplayTree", "BoostSet");
+    print_row("time, ns", splay.time_, boost.time_);
+    for (std::size_t i = 0; i < Perf::num_of_events; i++)
+        print_row(Perf::events[i].name_, splay.events_[i], boost.events_[i]);
+    std::printf("(mean +- 95%% confidence interval over %zu runs)\n", runs);
+
+    if (splay.hash_ != boost.hash_)
+    {
+        std::cerr << "Answers of SplayTree and BoostSet differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " [workload] [number of runs = 10]" << std::endl;
+        return 1;
+    }
+    auto runs = (argc == 3) ? std::stoul(argv[2]) : 10;
+
+    int fd = ::open(argv[1], O_RDONLY);
+    if (fd == -1)
+    {
+        std::cerr << "Can't open " << argv[1] << std::endl;
+        return 1;
+    }
+    Task::InputBuffer buffer {fd};
+    ::close(fd);
+
+    try
+    {
+        if (!Task::is_binary_workload(buffer.data(), buffer.size()))
+            return compare<int>(load(buffer), runs, Task::is_mixed_text_workload(buffer.data(), buffer.size()));
+
+        Task::BinaryInput input {buffer.data(), buffer.size()};
+        bool mixed = (input.header().type_ == Task::BinaryHeader::Mixed);
+        if (input.header().key_size_ == sizeof(std::int32_t))
+            return compare<std::int32_t>(load(input), runs, mixed);
+        return compare<std::int64_t>(load(input), runs, mixed);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Perf
+{
+
+struct EventDesc
+{
+    std::string_view name_;
+    std::uint32_t type_;
+    std::uint64_t config_;
+};
+
+constexpr std::uint64_t cache_event(std::uint64_t cache, std::uint64_t op, std::uint64_t result) noexcept
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+constexpr std::array events {
+    EventDesc{"cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    EventDesc{"instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    EventDesc{"L1d misses",    PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    EventDesc{"LLC misses",    PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL,  PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    EventDesc{"branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    EventDesc{"dTLB misses",   PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    EventDesc{"page faults",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+constexpr std::size_t num_of_events = events.size();
+
+// One perf_event_open counter of this thread. Counter that can't be opened
+// (no PMU in virtual machine, perf_event_paranoid) just reports no value.
+class Counter final
+{
+    int fd_ = -1;
+
+    struct ReadFormat
+    {
+        std::uint64_t value_, time_enabled_, time_running_;
+    };
+public:
+    explicit Counter(const EventDesc& desc)
+    {
+        perf_event_attr attr {};
+        attr.size   = sizeof(attr);
+        attr.type   = desc.type_;
+        attr.config = desc.config_;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    ~Counter()
+    {
+        if (fd_ != -1)
+            ::close(fd_);
+    }
+
+    bool valid() const noexcept {return fd_ != -1;}
+
+    void start() noexcept
+    {
+        if (!valid())
+            return;
+        ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    void stop() noexcept
+    {
+        if (valid())
+            ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    // value scaled by time of running, when counters are multiplexed
+    std::optional<double> value() const noexcept
+    {
+        ReadFormat data {};
+        if (!valid() || ::read(fd_, &data, sizeof(data)) != sizeof(data) || !data.time_running_)
+            return std::nullopt;
+        return static_cast<double>(data.value_) * data.time_enabled_ / data.time_running_;
+    }
+}; // class Counter
+} // namespace Perf
@@ -0,0 +1,210 @@
+#pragma once
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Task
+{
+
+namespace detail
+{
+// converts 8 ascii digits (first digit in lowest byte) to number without branches
+inline std::uint64_t parse_eight_digits(std::uint64_t chunk) noexcept
+{
+    constexpr std::uint64_t mask = 0x000000FF000000FF;
+    constexpr std::uint64_t mul1 = 100 + (1000000ULL << 32);
+    constexpr std::uint64_t mul2 = 1 + (10000ULL << 32);
+
+    chunk -= 0x3030303030303030;
+    chunk  = (chunk * 10) + (chunk >> 8);
+    return (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+}
+
+inline bool is_digit(char c) noexcept {return static_cast<unsigned char>(c - '0') < 10;}
+} // namespace detail
+
+// Whole input in memory: stdin is mapped if it is regular file
+// and read by large blocks otherwise (pipe, terminal)
+class InputBuffer final
+{
+    const char* begin_ = nullptr;
+    const char* end_   = nullptr;
+    const char* cur_   = nullptr;
+
+    void*  map_ = nullptr;
+    std::size_t map_size_ = 0;
+    std::vector<char> data_ {};
+
+    static constexpr std::size_t block_size = 1 << 20;
+public:
+    explicit InputBuffer(int fd = STDIN_FILENO)
+    {
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            map_size_ = st.st_size;
+            map_ = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+            if (map_ != MAP_FAILED)
+            {
+                ::madvise(map_, map_size_, MADV_SEQUENTIAL);
+                begin_ = static_cast<const char*>(map_);
+                end_   = begin_ + map_size_;
+                cur_   = begin_;
+                return;
+            }
+            map_ = nullptr;
+        }
+
+        std::size_t size = 0;
+        for (;;)
+        {
+            data_.resize(size + block_size);
+            auto got = ::read(fd, data_.data() + size, block_size);
+            if (got < 0)
+                throw std::runtime_error{"InputBuffer: read failed"};
+            if (got == 0)
+                break;
+            size += got;
+        }
+        data_.resize(size);
+        begin_ = data_.data();
+        end_   = begin_ + size;
+        cur_   = begin_;
+    }
+
+    InputBuffer(const InputBuffer&) = delete;
+    InputBuffer& operator=(const InputBuffer&) = delete;
+
+    ~InputBuffer()
+    {
+        if (map_)
+            ::munmap(map_, map_size_);
+    }
+
+    const char* data() const noexcept {return begin_;}
+    std::size_t size() const noexcept {return end_ - begin_;}
+
+    // reads next integer, returns false at the end of input
+    template<std::integral T>
+    bool read(T& value) noexcept
+    {
+        while (cur_ != end_ && !detail::is_digit(*cur_) && *cur_ != '-')
+            ++cur_;
+        if (cur_ == end_)
+            return false;
+
+        bool negative = (*cur_ == '-');
+        if (negative)
+            ++cur_;
+
+        auto first = cur_;
+        while (cur_ != end_ && detail::is_digit(*cur_))
+            ++cur_;
+
+        std::uint64_t number = 0;
+        auto len = cur_ - first;
+        // take leading digits so that rest of number is whole chunks of eight
+        auto head = len % 8;
+        for (auto itr = first; itr != first + head; ++itr)
+            number = number * 10 + (*itr - '0');
+        for (auto itr = first + head; itr != cur_; itr += 8)
+        {
+            std::uint64_t chunk = 0;
+            std::memcpy(&chunk, itr, sizeof(chunk));
+            number = number * 100000000 + detail::parse_eight_digits(chunk);
+        }
+
+        value = negative ? static_cast<T>(0 - number) : static_cast<T>(number);
+        return true;
+    }
+}; // class InputBuffer
+
+// All output is collected in one buffer and written with one syscall
+class OutputBuffer final
+{
+    std::vector<char> data_ {};
+    std::size_t size_ = 0;
+    int fd_;
+
+    void reserve(std::size_t extra)
+    {
+        if (size_ + extra > data_.size())
+            data_.resize(std::max(2 * data_.size(), size_ + extra));
+    }
+public:
+    explicit OutputBuffer(int fd = STDOUT_FILENO, std::size_t capacity = 1 << 20)
+    :data_ (capacity), fd_ {fd}
+    {}
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    ~OutputBuffer()
+    {
+        flush();
+    }
+
+    template<std::integral T>
+    void write(T value)
+    {
+        reserve(std::numeric_limits<T>::digits10 + 2);
+        auto [ptr, ec] = std::to_chars(data_.data() + size_, data_.data() + data_.size(), value);
+        size_ = ptr - data_.data();
+    }
+
+    void write(char c)
+    {
+        reserve(1);
+        data_[size_++] = c;
+    }
+
+    void write(const void* data, std::size_t size)
+    {
+        reserve(size);
+        std::memcpy(data_.data() + size_, data, size);
+        size_ += size;
+    }
+
+    std::size_t size() const noexcept {return size_;}
+
+    void flush()
+    {
+        auto ptr = data_.data();
+        while (size_)
+        {
+            auto written = ::write(fd_, ptr, size_);
+            if (written <= 0)
+                break;
+            ptr   += written;
+            size_ -= written;
+        }
+        size_ = 0;
+    }
+}; // class OutputBuffer
+
+// old iostream path, same interface as buffers above
+class StreamInput final
+{
+public:
+    template<std::integral T>
+    bool read(T& value) {return static_cast<bool>(std::cin >> value);}
+};
+
+class StreamOutput final
+{
+public:
+    template<typename T>
+    void write(const T& value) {std::cout << value;}
+
+    void flush() {std::cout.flush();}
+};
+} // namespace Task
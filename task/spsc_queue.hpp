@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+namespace Task
+{
+
+// Bounded queue of one producer and one consumer: ring of Capacity slots, tail is moved only by producer
+// and head only by consumer, so both ends work without locks. Full (empty) queue is waited by yield,
+// threads of pipeline may share one core. Failed end closes queue, so other end doesn't wait forever
+template<typename T, std::size_t Capacity>
+class SpscQueue final
+{
+    static_assert(std::has_single_bit(Capacity), "capacity of SpscQueue is power of 2");
+
+    std::array<T, Capacity> slots_ {};
+    // own cache lines, producer and consumer don't invalidate lines of each other
+    alignas(64) std::atomic<std::size_t> head_ {0};
+    alignas(64) std::atomic<std::size_t> tail_ {0};
+    std::atomic<bool> closed_ {false};
+
+public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // producer only, value is dropped if queue is full and closed
+    void push(T value)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        while (tail - head_.load(std::memory_order_acquire) == Capacity)
+        {
+            if (closed_.load(std::memory_order_acquire))
+                return;
+            std::this_thread::yield();
+        }
+        slots_[tail % Capacity] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    // consumer only, closed and empty queue gives T{}
+    T pop()
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        while (tail_.load(std::memory_order_acquire) == head)
+        {
+            // values pushed before close are seen after it
+            if (closed_.load(std::memory_order_acquire) && tail_.load(std::memory_order_acquire) == head)
+                return T{};
+            std::this_thread::yield();
+        }
+        auto value = std::move(slots_[head % Capacity]);
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // any end, waits of other end stop
+    void close() noexcept
+    {
+        closed_.store(true, std::memory_order_release);
+    }
+}; // class SpscQueue
+} // namespace Task
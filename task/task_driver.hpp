@@ -0,0 +1,484 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "fast_io.hpp"
+#include "spsc_queue.hpp"
+#include "workload.hpp"
+
+namespace Task
+{
+
+// number of keys in [left bound, right bound]
+template<typename Set, typename KeyT>
+std::size_t range_count(Set& set, const KeyT& left_bound, const KeyT& right_bound)
+{
+#ifdef SPLAY
+    return set.distance(set.lower_bound(left_bound), set.upper_bound(right_bound));
+#else
+    return set.number_not_greater_than(right_bound) - set.number_less_than(left_bound);
+#endif
+}
+
+// answers range requests one by one
+template<typename KeyT, typename Set, typename Input, typename Output>
+void answer(Set& set, Input& input, Output& output)
+{
+    using key_type = KeyT;
+
+    std::size_t num_of_reqs = 0;
+    input.read(num_of_reqs);
+    for (std::size_t i = 0; i < num_of_reqs; i++)
+    {
+        key_type left_bound = 0, right_bound = 0;
+        input.read(left_bound);
+        input.read(right_bound);
+        output.write(range_count(set, left_bound, right_bound));
+        output.write(' ');
+    }
+    output.write('\n');
+    output.flush();
+}
+
+// Reads all requests, then answers ranks of all bounds by one merge of sorted bounds with keys of set
+// in order: O(n + q log q) with sequential access to keys instead of q descents. Answers are written
+// in order of requests
+template<typename KeyT, typename Set, typename Input, typename Output>
+void answer_offline(const Set& set, Input& input, Output& output)
+{
+    using key_type = KeyT;
+
+    // bound 2i is left bound of request i (keys less than it are counted), 2i + 1 is right one (not greater)
+    struct Bound
+    {
+        key_type key_;
+        std::size_t index_;
+    };
+
+    std::size_t num_of_reqs = 0;
+    input.read(num_of_reqs);
+    std::vector<Bound> bounds(2 * num_of_reqs);
+    for (std::size_t i = 0; i < bounds.size(); i++)
+    {
+        bounds[i].index_ = i;
+        input.read(bounds[i].key_);
+    }
+    // on equal keys left bounds go first, they count fewer keys
+    std::sort(bounds.begin(), bounds.end(), [](const Bound& lhs, const Bound& rhs)
+              {return lhs.key_ < rhs.key_ || (lhs.key_ == rhs.key_ && lhs.index_ % 2 < rhs.index_ % 2);});
+
+    std::vector<std::size_t> ranks(bounds.size());
+    auto itr = set.begin();
+    std::size_t rank = 0;
+    for (auto& bound: bounds)
+    {
+        if (bound.index_ % 2 == 0)
+            for (; itr != set.end() && *itr < bound.key_; ++itr)
+                rank++;
+        else
+            for (; itr != set.end() && !(bound.key_ < *itr); ++itr)
+                rank++;
+        ranks[bound.index_] = rank;
+    }
+
+    for (std::size_t i = 0; i < num_of_reqs; i++)
+    {
+        output.write(ranks[2 * i + 1] - ranks[2 * i]);
+        output.write(' ');
+    }
+    output.write('\n');
+    output.flush();
+}
+
+// Reads all requests and answers chunks of them in threads, every answer goes to place of its request.
+// Queries should not change set: it is frozen copy or tree without splaying
+template<typename KeyT, typename Set, typename Input, typename Output>
+void answer_parallel(const Set& set, Input& input, Output& output, unsigned threads)
+{
+    using key_type = KeyT;
+
+    std::size_t num_of_reqs = 0;
+    input.read(num_of_reqs);
+    std::vector<key_type> bounds(2 * num_of_reqs);
+    for (auto& bound: bounds)
+        input.read(bound);
+
+    std::vector<std::size_t> answers(num_of_reqs);
+    auto chunk = [&](unsigned index)
+    {
+        auto first = num_of_reqs * index / threads, last = num_of_reqs * (index + 1) / threads;
+        for (auto i = first; i < last; i++)
+            answers[i] = range_count(set, bounds[2 * i], bounds[2 * i + 1]);
+    };
+
+    std::vector<std::future<void>> futures {};
+    for (unsigned i = 1; i < threads; i++)
+        try
+        {
+            futures.push_back(std::async(std::launch::async, chunk, i));
+        }
+        catch (const std::system_error&)
+        {
+            // no more threads
+            chunk(i);
+        }
+    chunk(0);
+    for (auto& future: futures)
+        future.get();
+
+    for (auto answer: answers)
+    {
+        output.write(answer);
+        output.write(' ');
+    }
+    output.write('\n');
+    output.flush();
+}
+
+// trees that make immutable copy for phase without inserts
+template<template<typename...> class Tree>
+concept freezable = requires(const Tree<int>& tree) {tree.freeze();};
+
+// modes of answering requests, set by flags of driver (mixed is set by kind of workload)
+struct Options
+{
+    bool freeze  = false;
+    bool offline = false;
+    bool pipeline = false;
+    bool mixed = false;
+    unsigned threads = 1;
+};
+
+// Mixed workload: keys, then operations (see Task::Operation) applied to tree in order of workload,
+// answer of every operation is printed
+template<typename KeyT, template<typename...> class Tree, typename Input, typename Output>
+void run_mixed(Input& input, Output& output)
+{
+    using key_type = KeyT;
+    Tree<key_type> tree {};
+
+    std::size_t num_of_keys = 0;
+    input.read(num_of_keys);
+    for (std::size_t i = 0; i < num_of_keys; i++)
+    {
+        key_type key = 0;
+        input.read(key);
+        tree.insert(key);
+    }
+
+    std::size_t num_of_ops = 0;
+    input.read(num_of_ops);
+    for (std::size_t i = 0; i < num_of_ops; i++)
+    {
+        std::uint64_t code = 0;
+        key_type key = 0, second_key = 0;
+        input.read(code);
+        input.read(key);
+        input.read(second_key);
+        if (code > static_cast<std::uint64_t>(Operation::Range))
+            throw std::runtime_error{"Unknown operation " + std::to_string(code) + " of mixed workload"};
+
+        switch (static_cast<Operation>(code))
+        {
+            case Operation::Insert:
+                output.write(static_cast<int>(tree.insert(key).second));
+                break;
+
+            case Operation::Erase:
+            {
+                auto itr = tree.find(key);
+                bool found = (itr != tree.end());
+                if (found)
+                    tree.erase(itr);
+                output.write(static_cast<int>(found));
+                break;
+            }
+
+            case Operation::Find:
+                output.write(static_cast<int>(tree.find(key) != tree.end()));
+                break;
+
+            case Operation::Rank:
+                output.write(tree.number_less_than(key));
+                break;
+
+            case Operation::Range:
+                output.write(range_count(tree, key, second_key));
+                break;
+        }
+        output.write(' ');
+    }
+    output.write('\n');
+    output.flush();
+}
+
+template<typename KeyT, typename Set, typename Input, typename Output>
+void answer(Set& set, Input& input, Output& output, const Options& options)
+{
+    if (options.offline)
+        answer_offline<KeyT>(set, input, output);
+    else if (options.threads > 1)
+        answer_parallel<KeyT>(set, input, output, options.threads);
+    else
+        answer<KeyT>(set, input, output);
+}
+
+// Three stages in own threads: parser reads keys and bounds by blocks, tree (this thread) inserts keys
+// and answers requests, writer formats answers. Blocks go between stages by SpscQueue, so parsing and
+// formatting overlap with work of tree. Stage which throws closes its queues: other stages end
+// and the first error is rethrown
+template<typename KeyT, template<typename...> class Tree, typename Input, typename Output>
+void run_pipelined(Input& input, Output& output, const Options& options)
+{
+    using key_type = KeyT;
+
+    // numbers in block of parser, even: requests are not split between blocks
+    constexpr std::size_t block_size = 1 << 12;
+    enum class Stage {Keys, Requests, End};
+    struct Block
+    {
+        Stage stage_ = Stage::End;
+        std::vector<key_type> values_ {};
+    };
+    SpscQueue<Block, 64> parsed {};
+    // empty answers end output
+    SpscQueue<std::vector<std::size_t>, 64> answered {};
+
+    auto parser = std::async(std::launch::async, [&]
+    {
+        try
+        {
+            auto parse = [&](Stage stage, std::size_t count)
+            {
+                for (std::size_t done = 0; done < count;)
+                {
+                    Block block {stage, std::vector<key_type>(std::min(block_size, count - done))};
+                    for (auto& value: block.values_)
+                        input.read(value);
+                    done += block.values_.size();
+                    parsed.push(std::move(block));
+                }
+            };
+            std::size_t num_of_keys = 0, num_of_reqs = 0;
+            input.read(num_of_keys);
+            parse(Stage::Keys, num_of_keys);
+            input.read(num_of_reqs);
+            parse(Stage::Requests, 2 * num_of_reqs);
+            parsed.push(Block{});
+        }
+        catch (...)
+        {
+            // tree stage gets end of input
+            parsed.close();
+            throw;
+        }
+    });
+
+    auto writer = std::async(std::launch::async, [&]
+    {
+        try
+        {
+            for (auto answers = answered.pop(); !answers.empty(); answers = answered.pop())
+                for (auto answer: answers)
+                {
+                    output.write(answer);
+                    output.write(' ');
+                }
+            output.write('\n');
+            output.flush();
+        }
+        catch (...)
+        {
+            // answers of tree stage are dropped
+            answered.close();
+            throw;
+        }
+    });
+
+    try
+    {
+        Tree<key_type> tree {};
+        auto block = parsed.pop();
+        for (; block.stage_ == Stage::Keys; block = parsed.pop())
+            for (auto& key: block.values_)
+                tree.insert(key);
+
+        auto answer_blocks = [&](auto& set)
+        {
+            for (; block.stage_ == Stage::Requests; block = parsed.pop())
+            {
+                auto& bounds = block.values_;
+                std::vector<std::size_t> answers(bounds.size() / 2);
+                for (std::size_t i = 0; i < answers.size(); i++)
+                    answers[i] = range_count(set, bounds[2 * i], bounds[2 * i + 1]);
+                answered.push(std::move(answers));
+            }
+            answered.push({});
+        };
+        if constexpr (freezable<Tree>)
+            if (options.freeze)
+            {
+                auto frozen = tree.freeze();
+                answer_blocks(frozen);
+            }
+        if (!options.freeze || !freezable<Tree>)
+            answer_blocks(tree);
+    }
+    catch (...)
+    {
+        // parser and writer end, futures wait for them
+        parsed.close();
+        answered.close();
+        throw;
+    }
+    parser.get();
+    writer.get();
+}
+
+// All keys go before all requests, so with freeze requests are answered by frozen copy of tree.
+// Queries of freezable (splay) tree change it, so threads share frozen copy of it
+template<typename KeyT, template<typename...> class Tree, typename Input, typename Output>
+void run(Input& input, Output& output, const Options& options = {})
+{
+    using key_type = KeyT;
+    if (options.mixed)
+    {
+        run_mixed<key_type, Tree>(input, output);
+        return;
+    }
+    if (options.pipeline)
+    {
+        run_pipelined<key_type, Tree>(input, output, options);
+        return;
+    }
+    Tree<key_type> tree {};
+
+    std::size_t num_of_keys = 0;
+    input.read(num_of_keys);
+
+    for (std::size_t i = 0; i < num_of_keys; i++)
+    {
+        key_type inp = 0;
+        input.read(inp);
+        tree.insert(inp);
+    }
+
+    if constexpr (freezable<Tree>)
+        if (options.freeze || options.threads > 1)
+        {
+            auto frozen = tree.freeze();
+            answer<key_type>(frozen, input, output, options);
+            return;
+        }
+    answer<key_type>(tree, input, output, options);
+}
+
+// Input is text or binary workload (detected by magic), keys of text workload are int.
+// Workload of requests or mixed workload of operations, flags below apply only to requests.
+// --stream-io: old std::cin/std::cout path for text workloads, to compare with buffered one
+// --freeze: requests are answered by frozen copy of tree, if tree can be frozen
+// --offline: all requests are read first and answered by one sweep over keys (see answer_offline)
+// --threads N: all requests are read first and answered by N threads (see answer_parallel)
+// --pipeline: parsing, tree and output work in three threads (see run_pipelined)
+template<template<typename...> class Tree>
+int driver_main(int argc, char** argv)
+{
+    bool stream_io = false;
+    Options options {};
+    auto parse_threads = [&](std::string_view number)
+    {
+        auto [end, error] = std::from_chars(number.data(), number.data() + number.size(), options.threads);
+        return error == std::errc{} && end == number.data() + number.size() && options.threads > 0;
+    };
+
+    bool valid = true;
+    for (int i = 1; i < argc && valid; i++)
+        if (std::string_view{argv[i]} == "--stream-io")
+            stream_io = true;
+        else if (std::string_view{argv[i]} == "--freeze" && freezable<Tree>)
+            options.freeze = true;
+        else if (std::string_view{argv[i]} == "--offline")
+            options.offline = true;
+        else if (std::string_view{argv[i]} == "--threads" && i + 1 < argc)
+            valid = parse_threads(argv[++i]);
+        else if (std::string_view{argv[i]} == "--pipeline")
+            options.pipeline = true;
+        else
+            valid = false;
+    // one sweep over keys is not split between threads, pipeline answers requests as they come
+    if (!valid || options.offline + (options.threads > 1) + options.pipeline > 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--stream-io]" << (freezable<Tree> ? " [--freeze]" : "")
+                  << " [--offline | --threads N | --pipeline] < workload" << std::endl;
+        return 1;
+    }
+
+    // operations change tree, so they are applied one by one
+    auto check_mixed = [&]
+    {
+        if (options.mixed && (options.freeze || options.offline || options.threads > 1 || options.pipeline))
+        {
+            std::cerr << "Operations of mixed workload are applied only one by one" << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    try
+    {
+        if (stream_io)
+        {
+            if (std::cin.peek() == BinaryHeader::magic[0])
+            {
+                std::cerr << "Binary workloads are read only by buffered input" << std::endl;
+                return 1;
+            }
+            if (std::cin.peek() == mixed_marker[0])
+            {
+                std::string marker {};
+                std::cin >> marker;
+                options.mixed = (marker == mixed_marker);
+            }
+            if (!check_mixed())
+                return 1;
+            StreamInput  input {};
+            StreamOutput output {};
+            run<int, Tree>(input, output, options);
+            return 0;
+        }
+
+        InputBuffer  buffer {};
+        OutputBuffer output {};
+        if (!is_binary_workload(buffer.data(), buffer.size()))
+        {
+            // marker is skipped by parser as any non-digits
+            options.mixed = is_mixed_text_workload(buffer.data(), buffer.size());
+            if (!check_mixed())
+                return 1;
+            run<int, Tree>(buffer, output, options);
+            return 0;
+        }
+
+        BinaryInput input {buffer.data(), buffer.size()};
+        options.mixed = (input.header().type_ == BinaryHeader::Mixed);
+        if (!check_mixed())
+            return 1;
+        if (input.header().key_size_ == sizeof(std::int32_t))
+            run<std::int32_t, Tree>(input, output, options);
+        else
+            run<std::int64_t, Tree>(input, output, options);
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+} // namespace Task
@@ -0,0 +1,143 @@
+#pragma once
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace Task
+{
+
+static_assert(std::endian::native == std::endian::little, "binary workloads are little-endian");
+
+// Operations of mixed workload. Every operation is three numbers: code, key and second key,
+// which is right bound of Range and 0 for others. Answer of Insert, Erase and Find is 1 or 0
+// (key was inserted, erased, found), of Rank is number of keys less than key
+enum class Operation : std::uint8_t
+{
+    Insert = 0,
+    Erase  = 1,
+    Find   = 2,
+    Rank   = 3,
+    Range  = 4,  // number of keys in [key, second key]
+};
+
+inline constexpr std::size_t numbers_of_operation = 3;
+
+// Text mixed workload is text workload with operations instead of requests, which starts with this word
+inline constexpr std::string_view mixed_marker = "mixed";
+
+inline bool is_mixed_text_workload(const char* data, std::size_t size) noexcept
+{
+    return std::string_view{data, size}.starts_with(mixed_marker);
+}
+
+// Binary workload: header, then num_of_keys_ keys and 2 * num_of_reqs_ bounds of range requests
+// (3 * num_of_reqs_ numbers of operations for Mixed), all of them packed integers of key_size_ bytes
+struct BinaryHeader
+{
+    static constexpr char magic[4] = {'S', 'P', 'T', 'W'};
+
+    enum Type : std::uint8_t
+    {
+        Ranges = 0, // keys, then pairs (left bound, right bound)
+        Mixed  = 1, // keys, then operations
+    };
+
+    char magic_[4] {};
+    std::uint8_t  key_size_ = 4;
+    std::uint8_t  type_     = Ranges;
+    std::uint16_t reserved_ = 0;
+    std::uint64_t num_of_keys_ = 0;
+    std::uint64_t num_of_reqs_ = 0;
+};
+static_assert(sizeof(BinaryHeader) == 24);
+
+inline bool is_binary_workload(const char* data, std::size_t size) noexcept
+{
+    return size >= sizeof(BinaryHeader) && !std::memcmp(data, BinaryHeader::magic, sizeof(BinaryHeader::magic));
+}
+
+// Reads binary workload with same interface as text InputBuffer: it returns
+// number of keys, keys, number of requests and bounds of requests one by one
+class BinaryInput final
+{
+    struct Segment
+    {
+        std::uint64_t count_;
+        const char*   data_;
+    };
+
+    BinaryHeader header_ {};
+    Segment segments_[2] {};
+    int seg_ = 0;
+    // 0 - count of segment is not read yet, i > 0 - element i - 1 is next
+    std::uint64_t index_ = 0;
+
+    template<std::integral T>
+    T element(const char* data, std::uint64_t index) const noexcept
+    {
+        if (header_.key_size_ == sizeof(std::int32_t))
+        {
+            std::int32_t value = 0;
+            std::memcpy(&value, data + index * sizeof(value), sizeof(value));
+            return static_cast<T>(value);
+        }
+        std::int64_t value = 0;
+        std::memcpy(&value, data + index * sizeof(value), sizeof(value));
+        return static_cast<T>(value);
+    }
+public:
+    BinaryInput(const char* data, std::size_t size)
+    {
+        if (!is_binary_workload(data, size))
+            throw std::runtime_error{"BinaryInput: bad magic"};
+        std::memcpy(&header_, data, sizeof(header_));
+
+        if (header_.key_size_ != sizeof(std::int32_t) && header_.key_size_ != sizeof(std::int64_t))
+            throw std::runtime_error{"BinaryInput: keys must be int32 or int64"};
+        if (header_.type_ != BinaryHeader::Ranges && header_.type_ != BinaryHeader::Mixed)
+            throw std::runtime_error{"BinaryInput: unknown workload type"};
+        if (size != sizeof(header_) + (header_.num_of_keys_ + request_size() * header_.num_of_reqs_) * header_.key_size_)
+            throw std::runtime_error{"BinaryInput: truncated workload"};
+
+        auto keys = data + sizeof(header_);
+        segments_[0] = Segment{header_.num_of_keys_, keys};
+        segments_[1] = Segment{header_.num_of_reqs_, keys + header_.num_of_keys_ * header_.key_size_};
+    }
+
+    const BinaryHeader& header() const noexcept {return header_;}
+
+    // numbers in one request (operation)
+    std::uint64_t request_size() const noexcept
+    {
+        return (header_.type_ == BinaryHeader::Mixed) ? numbers_of_operation : 2;
+    }
+
+    template<std::integral T>
+    bool read(T& value) noexcept
+    {
+        while (seg_ < 2)
+        {
+            auto& segment = segments_[seg_];
+            auto elements = (seg_ == 0) ? segment.count_ : request_size() * segment.count_;
+            if (index_ == 0)
+            {
+                index_++;
+                value = static_cast<T>(segment.count_);
+                return true;
+            }
+            if (index_ <= elements)
+            {
+                value = element<T>(segment.data_, index_++ - 1);
+                return true;
+            }
+            seg_++;
+            index_ = 0;
+        }
+        return false;
+    }
+}; // class BinaryInput
+} // namespace Task
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include <set>
+#include "block_splay_tree.hpp"
+#include "set_checks.hpp"
+
+using namespace Container;
+using Tests::expect_same;
+
+TEST(BlockSplayTree, basic)
+{
+    BlockSplayTree<int> tree {5, 1, 3};
+    EXPECT_EQ(tree.size(), 3);
+    EXPECT_FALSE(tree.insert(3));
+    EXPECT_TRUE(tree.contains(1));
+    EXPECT_EQ(tree.count_in_range(2, 5), 2);
+    EXPECT_EQ(tree.count_in_range(5, 2), 0);
+    EXPECT_TRUE(tree.erase(1));
+    EXPECT_FALSE(tree.erase(1));
+    EXPECT_TRUE(tree.erase(3));
+    EXPECT_TRUE(tree.erase(5));
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.blocks(), 0);
+    EXPECT_EQ(tree.number_less_than(10), 0);
+    EXPECT_FALSE(tree.contains(10));
+
+    BlockSplayTree<int> moved {std::move(tree)};
+    EXPECT_TRUE(moved.insert(7));
+    EXPECT_EQ(moved.size(), 1);
+}
+
+TEST(BlockSplayTree, random_operations)
+{
+    constexpr int max = 5000;
+    BlockSplayTree<int> tree {};
+    std::set<int> expected {};
+    std::mt19937 rand {1};
+    // every key and both neighbours of range
+    std::vector<int> probes(max + 3);
+    std::iota(probes.begin(), probes.end(), -1);
+    for (int i = 0; i < 40000; i++)
+    {
+        int key = rand() % max;
+        if (rand() % 3)
+            EXPECT_EQ(tree.insert(key), expected.insert(key).second);
+        else
+            EXPECT_EQ(tree.erase(key), expected.erase(key) == 1);
+        ASSERT_EQ(tree.size(), expected.size());
+    }
+    expect_same(tree, expected, probes);
+
+    // erases merge blocks that became sparse
+    for (int key = 0; key < max; key++)
+        if (key % 16)
+        {
+            tree.erase(key);
+            expected.erase(key);
+        }
+    expect_same(tree, expected, probes);
+    EXPECT_LE(tree.blocks(), 2 * expected.size() / (BlockSplayTree<int>::block_capacity / 4) + 1);
+}
+
+TEST(BlockSplayTree, height)
+{
+    // sorted inserts fill blocks by halves, path of blocks is 16-32 times shorter than path of nodes
+    constexpr int size = 20000;
+    BlockSplayTree<int> tree {};
+    for (int key = 0; key < size; key++)
+        tree.insert(key);
+    auto shape = tree.shape();
+    EXPECT_EQ(shape.size, tree.blocks());
+    EXPECT_LE(shape.size, 2 * size / BlockSplayTree<int>::block_capacity + 1);
+    EXPECT_LE(shape.height, shape.size);
+
+    std::mt19937 rand {2};
+    for (int i = 0; i < 20000; i++)
+        EXPECT_TRUE(tree.contains(rand() % size));
+    EXPECT_LT(tree.shape().average_depth, 4 * std::log2(shape.size));
+    EXPECT_EQ(tree.number_less_than(size / 2), size / 2);
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+#include "../end-to-end/boost-set/include/boost_set.hpp"
+
+using namespace Container;
+
+namespace
+{
+// red-black tree with access to its nodes
+template<class Cmp = std::less<int>>
+class CheckedRBTree final : public detail::RBSearchTree<int, Cmp, detail::RBSubTreeRoot<int>>
+{
+    using base = detail::RBSearchTree<int, Cmp, detail::RBSubTreeRoot<int>>;
+    using typename base::node_ptr;
+    using typename base::size_type;
+    using base::Null_;
+    using base::root_;
+    using base::size_;
+
+public:
+    CheckedRBTree() = default;
+
+    template<std::input_iterator InpIt>
+    CheckedRBTree(InpIt first, InpIt last): base::RBSearchTree(first, last) {}
+
+    using base::size;
+    using base::empty;
+    using base::maximum;
+    using base::minimum;
+    using base::find;
+    using base::merge;
+    using base::begin;
+    using base::end;
+
+    // checks colors, black heights, parent links, sizes of subtrees, min and max,
+    // links on sentinel of other tree are errors
+    void expect_valid(const std::set<int>& expected, const CheckedRBTree& other) const
+    {
+        ASSERT_EQ(size(), expected.size());
+        ASSERT_TRUE(std::equal(begin(), end(), expected.begin(), expected.end()));
+        EXPECT_EQ(Null_->color_, detail::Colors::Black);
+        EXPECT_EQ(Null_->size_, 0);
+        EXPECT_EQ(root_->color_, detail::Colors::Black);
+        EXPECT_EQ(root_->size_, size_);
+        expect_valid(root_, Null_, other.Null_ != Null_ ? other.Null_ : nullptr);
+        if (expected.empty())
+        {
+            EXPECT_EQ(root_, Null_);
+            return;
+        }
+        EXPECT_EQ(minimum(), *expected.begin());
+        EXPECT_EQ(maximum(), *expected.rbegin());
+        EXPECT_EQ(Null_->left_, detail::find_min(root_, Null_));
+        EXPECT_EQ(Null_->right_, detail::find_max(root_, Null_));
+    }
+
+private:
+    // returns black height of subtree
+    size_type expect_valid(node_ptr node, node_ptr parent, node_ptr other_null) const
+    {
+        if (node == other_null)
+        {
+            ADD_FAILURE() << "link on sentinel of other tree";
+            return 0;
+        }
+        if (node == Null_)
+            return 1;
+        EXPECT_EQ(node->parent_, parent);
+        if (node->color_ == detail::Colors::Red)
+        {
+            EXPECT_EQ(node->left_->color_, detail::Colors::Black);
+            EXPECT_EQ(node->right_->color_, detail::Colors::Black);
+        }
+        auto left_height  = expect_valid(node->left_, node, other_null);
+        auto right_height = expect_valid(node->right_, node, other_null);
+        EXPECT_EQ(left_height, right_height);
+        EXPECT_EQ(node->size_, node->left_->size_ + node->right_->size_ + 1);
+        return left_height + (node->color_ == detail::Colors::Black);
+    }
+}; // class CheckedRBTree
+
+// counts comparisons of all trees
+struct CountingLess
+{
+    static inline std::size_t count = 0;
+
+    bool operator()(int lhs, int rhs) const noexcept
+    {
+        count++;
+        return lhs < rhs;
+    }
+};
+
+std::set<int> range_set(int first, int last)
+{
+    std::set<int> set {};
+    for (int i = first; i < last; i++)
+        set.insert(i);
+    return set;
+}
+
+// merges rhs into lhs, nodes are moved without reallocation
+void expect_merge(const std::set<int>& lhs_set, const std::set<int>& rhs_set)
+{
+    CheckedRBTree<> lhs(lhs_set.begin(), lhs_set.end()), rhs(rhs_set.begin(), rhs_set.end());
+    std::vector<const int*> keys {};
+    for (auto& key: rhs)
+        keys.push_back(&key);
+
+    std::set<int> expected_lhs {lhs_set}, expected_rhs {};
+    for (auto key: rhs_set)
+        if (!expected_lhs.insert(key).second)
+            expected_rhs.insert(key);
+
+    lhs.merge(rhs);
+    lhs.expect_valid(expected_lhs, rhs);
+    rhs.expect_valid(expected_rhs, lhs);
+    for (auto key: keys)
+        EXPECT_EQ(expected_rhs.contains(*key) ? &*rhs.find(*key) : &*lhs.find(*key), key);
+}
+} // namespace
+
+TEST(BoostSet, merge_other_after)
+{
+    for (auto [lhs_size, rhs_size]: {std::pair{2, 2}, {100, 100}, {1000, 10}, {10, 1000}, {2, 500}, {500, 2}})
+        expect_merge(range_set(0, lhs_size), range_set(lhs_size, lhs_size + rhs_size));
+}
+
+TEST(BoostSet, merge_other_before)
+{
+    for (auto [lhs_size, rhs_size]: {std::pair{2, 2}, {100, 100}, {1000, 10}, {10, 1000}, {2, 500}, {500, 2}})
+        expect_merge(range_set(rhs_size, rhs_size + lhs_size), range_set(0, rhs_size));
+}
+
+TEST(BoostSet, merge_one_node)
+{
+    for (int size: {1, 2, 3, 100})
+    {
+        // other is one node
+        expect_merge(range_set(0, size), {size});
+        expect_merge(range_set(0, size), {-1});
+        expect_merge(range_set(0, size), {size / 2});
+        // this is one node
+        expect_merge({-1}, range_set(0, size));
+        expect_merge({size}, range_set(0, size));
+        expect_merge({size / 2}, range_set(0, size));
+    }
+}
+
+TEST(BoostSet, merge_overlapping)
+{
+    std::mt19937 rand {13};
+    for (auto [lhs_size, rhs_size]: {std::pair<std::size_t, std::size_t>{0, 0}, {0, 50}, {50, 0}, {300, 20}, {20, 300}, {2000, 7}, {7, 2000}, {3000, 3000}})
+    {
+        std::set<int> lhs_set {}, rhs_set {};
+        while (lhs_set.size() < lhs_size)
+            lhs_set.insert(rand() % (2 * (lhs_size + rhs_size) + 1));
+        while (rhs_set.size() < rhs_size)
+            rhs_set.insert(rand() % (2 * (lhs_size + rhs_size) + 1));
+        expect_merge(lhs_set, rhs_set);
+    }
+    // every key of other is duplicate
+    expect_merge(range_set(0, 100), range_set(20, 60));
+}
+
+TEST(BoostSet, self_merge)
+{
+    auto set = range_set(0, 100);
+    CheckedRBTree<> tree(set.begin(), set.end());
+    tree.merge(tree);
+    tree.expect_valid(set, tree);
+
+    BoostSet<int> boost_set {3, 1, 2};
+    boost_set.merge(boost_set);
+    EXPECT_EQ(boost_set, (BoostSet<int>{1, 2, 3}));
+    EXPECT_EQ(boost_set.number_less_than(3), 2);
+}
+
+TEST(BoostSet, merge_keeps_order_statistics)
+{
+    BoostSet<int> low {}, high {};
+    for (int i = 0; i < 1000; i++)
+        low.insert(i);
+    for (int i = 1000; i < 1500; i++)
+        high.insert(i);
+    high.merge(low);
+    EXPECT_TRUE(low.empty());
+    EXPECT_EQ(high.size(), 1500);
+    for (int i: {0, 1, 999, 1000, 1499})
+    {
+        EXPECT_EQ(high.kth_smallest(i), i);
+        EXPECT_EQ(high.number_less_than(i), i);
+    }
+}
+
+TEST(BoostSet, merge_adaptive)
+{
+    // interleaved keys: reinsert of every node costs m log(n + m) comparisons, split/join union is linear
+    constexpr int size = 1 << 14;
+    std::vector<int> evens {}, odds {};
+    for (int i = 0; i < size; i++)
+    {
+        evens.push_back(2 * i);
+        odds.push_back(2 * i + 1);
+    }
+    CheckedRBTree<CountingLess> lhs(evens.begin(), evens.end()), rhs(odds.begin(), odds.end());
+
+    CountingLess::count = 0;
+    lhs.merge(rhs);
+    EXPECT_LT(CountingLess::count, 12 * size);
+    EXPECT_TRUE(rhs.empty());
+    lhs.expect_valid(range_set(0, 2 * size), rhs);
+}
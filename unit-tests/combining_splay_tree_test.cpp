@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <thread>
+#include "combining_splay_tree.hpp"
+
+using namespace Container;
+
+TEST(CombiningSplayTree, sequential)
+{
+    EXPECT_THROW(CombiningSplayTree<int>(0), std::invalid_argument);
+
+    CombiningSplayTree<int> tree {1};
+    std::set<int> expected {};
+    EXPECT_TRUE(tree.empty());
+
+    std::mt19937 rand {1};
+    for (int i = 0; i < 20000; i++)
+    {
+        int key = rand() % 3000;
+        switch (rand() % 3)
+        {
+            case 0:  EXPECT_EQ(tree.insert(key), expected.insert(key).second); break;
+            case 1:  EXPECT_EQ(tree.erase(key), expected.erase(key) == 1); break;
+            default: EXPECT_EQ(tree.contains(key), expected.contains(key));
+        }
+        ASSERT_EQ(tree.size(), expected.size());
+    }
+    EXPECT_EQ(tree.locked([](const auto& set) {return set.number_less_than(1500);}),
+              std::distance(expected.begin(), expected.lower_bound(1500)));
+    EXPECT_DOUBLE_EQ(tree.average_batch(), 1.0);
+}
+
+TEST(CombiningSplayTree, concurrent)
+{
+    constexpr int threads = 8, per_thread = 20000;
+    CombiningSplayTree<int> tree {4};
+
+    std::vector<std::thread> workers {};
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&tree, t]
+        {
+            std::mt19937 rand(t);
+            // every thread owns keys equal to t modulo threads
+            std::set<int> own {};
+            for (int i = 0; i < per_thread; i++)
+            {
+                int key = static_cast<int>(rand() % (per_thread / 4)) * threads + t;
+                if (rand() % 2)
+                    EXPECT_EQ(tree.insert(key), own.insert(key).second);
+                else
+                    EXPECT_EQ(tree.erase(key), own.erase(key) == 1);
+                EXPECT_EQ(tree.contains(key), own.contains(key));
+            }
+        });
+    for (auto& worker: workers)
+        worker.join();
+
+    std::size_t present = 0;
+    for (int key = 0; key < per_thread * threads / 4; key++)
+        present += tree.contains(key);
+    EXPECT_EQ(tree.size(), present);
+    EXPECT_EQ(tree.locked([](const auto& set) {return set.size();}), present);
+    EXPECT_GE(tree.average_batch(), 1.0);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <set>
+#include <thread>
+#include "concurrent_splay_tree.hpp"
+
+using namespace Container;
+
+TEST(ConcurrentSplayTree, sequential)
+{
+    ConcurrentSplayTree<int> tree {};
+    std::set<int> expected {};
+    EXPECT_TRUE(tree.empty());
+    EXPECT_FALSE(tree.contains(0));
+    EXPECT_FALSE(tree.erase(0));
+
+    std::mt19937 rand {1};
+    for (int i = 0; i < 20000; i++)
+    {
+        int key = rand() % 3000;
+        switch (rand() % 3)
+        {
+            case 0:  EXPECT_EQ(tree.insert(key), expected.insert(key).second); break;
+            case 1:  EXPECT_EQ(tree.erase(key), expected.erase(key) == 1); break;
+            default: EXPECT_EQ(tree.contains(key), expected.contains(key));
+        }
+        ASSERT_EQ(tree.size(), expected.size());
+    }
+    for (int key = 0; key < 3000; key++)
+        EXPECT_EQ(tree.contains(key), expected.contains(key));
+}
+
+TEST(ConcurrentSplayTree, adapts_to_accesses)
+{
+    // sorted inserts make path
+    constexpr int size = 1000;
+    ConcurrentSplayTree<int> tree {};
+    for (int key = 0; key < size; key++)
+        tree.insert(key);
+    EXPECT_EQ(tree.shape().height, size);
+
+    std::mt19937 rand {2};
+    for (int i = 0; i < 100 * size; i++)
+        EXPECT_TRUE(tree.contains(rand() % size));
+    auto uniform = tree.shape();
+    EXPECT_EQ(uniform.size, size);
+    EXPECT_LT(uniform.average_depth, 2 * std::log2(size));
+
+    // hot key comes close to root
+    for (int i = 0; i < 100 * size; i++)
+        tree.contains(size / 3);
+    auto shape = tree.shape();
+    EXPECT_LT(shape.average_depth, uniform.average_depth + 2);
+    for (int key = 0; key < size; key++)
+        EXPECT_TRUE(tree.contains(key));
+}
+
+TEST(ConcurrentSplayTree, concurrent)
+{
+    constexpr int threads = 4, per_thread = 20000;
+    ConcurrentSplayTree<int> tree {};
+
+    std::vector<std::thread> workers {};
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&tree, t]
+        {
+            std::mt19937 rand(t);
+            // every thread owns keys equal to t modulo threads, keys of others are only looked up
+            std::set<int> own {};
+            for (int i = 0; i < per_thread; i++)
+            {
+                int key = static_cast<int>(rand() % (per_thread / 4)) * threads + t;
+                if (rand() % 2)
+                    EXPECT_EQ(tree.insert(key), own.insert(key).second);
+                else
+                    EXPECT_EQ(tree.erase(key), own.erase(key) == 1);
+                EXPECT_EQ(tree.contains(key), own.contains(key));
+                tree.contains(static_cast<int>(rand() % per_thread));
+            }
+            for (int key = t; key < per_thread; key += threads)
+                EXPECT_EQ(tree.contains(key), own.contains(key));
+        });
+    for (auto& worker: workers)
+        worker.join();
+
+    std::size_t present = 0;
+    for (int key = 0; key < per_thread; key++)
+        present += tree.contains(key);
+    EXPECT_EQ(tree.size(), present);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <set>
+#include "elias_fano_set.hpp"
+#include "set_checks.hpp"
+
+using namespace Container;
+using Tests::expect_same;
+
+TEST(EliasFanoSet, empty)
+{
+    EliasFanoSet<int> set {};
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.number_less_than(0), 0);
+    EXPECT_EQ(set.count_in_range(-10, 10), 0);
+    EXPECT_FALSE(set.contains(0));
+}
+
+TEST(EliasFanoSet, densities)
+{
+    // ranges from dense (no low bits) to sparse, buckets of many keys and of none
+    std::mt19937 rand {1};
+    for (int range: {1, 100, 1000, 100000, 100000000})
+        for (int size: {1, 7, 300, 3000})
+        {
+            std::set<int> expected {};
+            for (int i = 0; i < size; i++)
+                expected.insert(static_cast<int>(rand() % range) - range / 2);
+            EliasFanoSet<int> set(expected.begin(), expected.end());
+
+            std::vector<int> probes {*expected.begin() - 1, *expected.rbegin() + 1};
+            for (auto key: expected)
+            {
+                probes.push_back(key);
+                probes.push_back(key + 1);
+            }
+            for (int i = 0; i < 500; i++)
+                probes.push_back(static_cast<int>(rand() % range) - range / 2);
+            expect_same(set, expected, probes);
+        }
+}
+
+TEST(EliasFanoSet, extreme_keys)
+{
+    using limits = std::numeric_limits<std::int64_t>;
+    std::set<std::int64_t> expected {limits::min(), -1, 0, 1, 1LL << 40, limits::max() - 1, limits::max()};
+    EliasFanoSet<std::int64_t> set(expected.begin(), expected.end());
+    expect_same(set, expected, {limits::min(), limits::min() + 1, -2, -1, 0, 2, 1LL << 40, limits::max()});
+    EXPECT_EQ(set.count_in_range(-1, 1LL << 40), 4);
+
+    std::set<std::uint8_t> bytes {0, 1, 2, 254, 255};
+    expect_same(EliasFanoSet<std::uint8_t>(bytes.begin(), bytes.end()), bytes, {0, 3, 200, 255});
+}
+
+TEST(EliasFanoSet, bits_per_key)
+{
+    // keys with average gap 8: 2 bits of high part, 3 bits of low part
+    std::vector<int> keys(1 << 16);
+    std::mt19937 rand {2};
+    int key = 0;
+    for (auto& next: keys)
+        next = key += 1 + rand() % 15;
+    EliasFanoSet<int> set(keys.begin(), keys.end());
+    EXPECT_LT(8.0 * set.memory_usage() / keys.size(), 6.0);
+    EXPECT_EQ(set.kth_smallest(1000), keys[1000]);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <string>
+#include "frozen_set.hpp"
+#include "set_checks.hpp"
+
+using namespace Container;
+using Tests::expect_same;
+
+TEST(FrozenSet, empty)
+{
+    FrozenSet<int> frozen {};
+    EXPECT_TRUE(frozen.empty());
+    EXPECT_EQ(frozen.number_less_than(5), 0);
+    EXPECT_EQ(frozen.count_in_range(0, 10), 0);
+    EXPECT_FALSE(frozen.contains(0));
+    EXPECT_EQ(frozen.lower_bound(0), frozen.end());
+}
+
+TEST(FrozenSet, sizes_of_blocks)
+{
+    // every size around blocks and levels of index
+    std::mt19937 rand {1};
+    for (int size = 1; size < 600; size += (size < 70) ? 1 : 37)
+    {
+        std::vector<int> keys(size);
+        for (auto& key: keys)
+            key = static_cast<int>(rand() % 2000) - 1000;
+        std::set<int> expected(keys.begin(), keys.end());
+        FrozenSet<int> frozen(keys.begin(), keys.end());
+
+        std::vector<int> probes {};
+        for (int key = -1002; key <= 1002; key += 3)
+            probes.push_back(key);
+        expect_same(frozen, expected, probes);
+        EXPECT_EQ(frozen.count_in_range(-100, 100), std::distance(expected.lower_bound(-100), expected.upper_bound(100)));
+        EXPECT_EQ(frozen.count_in_range(100, -100), 0);
+    }
+}
+
+TEST(FrozenSet, keys_n_comparators)
+{
+    std::vector<std::int64_t> wide {};
+    for (std::int64_t i = 0; i < 1000; i++)
+        wide.push_back(i * i * 1000003);
+    std::set<std::int64_t, std::greater<>> expected_wide(wide.begin(), wide.end());
+    FrozenSet<std::int64_t, std::greater<>> frozen_wide(wide.begin(), wide.end());
+    expect_same(frozen_wide, expected_wide, {-1, 0, 1, 1000003, 1000004, 998001 * std::int64_t{1000003}, 1LL << 50});
+
+    // large keys: few of them in block (two strings of libstdc++)
+    std::vector<std::string> words {"splay", "tree", "zig", "zag", "rotation", "root", "key", "node", "splay"};
+    std::set<std::string> expected_words(words.begin(), words.end());
+    FrozenSet<std::string> frozen_words(words.begin(), words.end());
+    EXPECT_EQ(FrozenSet<std::string>::block_size, 64 / sizeof(std::string));
+    expect_same(frozen_words, expected_words, {"", "a", "key", "kez", "splay", "zag", "zz"});
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include "learned_set.hpp"
+#include "set_checks.hpp"
+
+using namespace Container;
+using Tests::expect_same;
+
+TEST(LearnedSet, empty)
+{
+    std::vector<int> none {};
+    EXPECT_THROW(LearnedSet<int>(none.begin(), none.end(), 0), std::invalid_argument);
+
+    LearnedSet<int> set {};
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.number_less_than(3), 0);
+    EXPECT_EQ(set.find(3), set.end());
+    EXPECT_EQ(set.count_in_range(0, 10), 0);
+}
+
+TEST(LearnedSet, uniform_keys)
+{
+    // keys as test_gen.py makes: uniform over range a few times larger than their number
+    std::mt19937 rand {1};
+    std::set<int> expected {};
+    while (expected.size() < 100000)
+        expected.insert(static_cast<int>(rand() % 400000) - 200000);
+    LearnedSet<int> set(expected.begin(), expected.end(), 16);
+
+    // few segments and two levels
+    auto segments = set.segments();
+    EXPECT_LT(segments.front(), expected.size() / 100);
+    EXPECT_EQ(segments.back(), 1);
+
+    std::vector<int> probes {};
+    for (int key = -200005; key <= 200005; key += 13)
+        probes.push_back(key);
+    expect_same(set, expected, probes);
+}
+
+TEST(LearnedSet, irregular_keys)
+{
+    // clusters, gaps and extreme keys make many segments and levels
+    std::mt19937 rand {2};
+    std::set<std::int64_t> expected {std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()};
+    for (int cluster = 0; cluster < 300; cluster++)
+    {
+        std::int64_t center = static_cast<std::int64_t>(rand()) * static_cast<std::int64_t>(rand() % 1000000);
+        for (int i = 0; i < 100; i++)
+            expected.insert(center + static_cast<std::int64_t>(std::pow(1.2, i % 60)));
+    }
+    std::vector<std::int64_t> probes(expected.begin(), expected.end());
+    for (auto key: expected)
+        probes.push_back(key + 1);
+
+    for (std::size_t epsilon: {1, 4, 64})
+    {
+        LearnedSet<std::int64_t> set(expected.begin(), expected.end(), epsilon);
+        EXPECT_EQ(set.segments().back(), 1);
+        expect_same(set, expected, probes);
+    }
+
+    std::set<double> reals {-1.5, 0, 1e-9, 2.5, 1e300};
+    expect_same(LearnedSet<double>(reals.begin(), reals.end(), 1), reals, {-2.0, -1.5, 0.0, 1e-10, 3.0, 1e301});
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <set>
+#include "splay_tree.hpp"
+#include "mapped_splay_tree.hpp"
+
+using namespace Container;
+
+TEST(MappedSplayTree, write_n_open)
+{
+    SplayTree<int> tree {8, 3, 10, 1, 6, 14, 4, 7, 13};
+    MappedSplayTree<int>::write("mapped_test.bin", tree);
+
+    MappedSplayTree<int> mapped {"mapped_test.bin"};
+    EXPECT_EQ(mapped.size(), tree.size());
+    EXPECT_EQ(mapped.minimum(), 1);
+    EXPECT_EQ(mapped.maximum(), 14);
+    EXPECT_TRUE(std::equal(mapped.begin(), mapped.end(), tree.begin(), tree.end()));
+    EXPECT_EQ(*std::prev(mapped.end()), 14);
+
+    MappedSplayTree<int> moved {std::move(mapped)};
+    EXPECT_EQ(moved.size(), tree.size());
+    EXPECT_TRUE(mapped.empty());
+
+    std::remove("mapped_test.bin");
+}
+
+TEST(MappedSplayTree, empty)
+{
+    SplayTree<int> tree {};
+    MappedSplayTree<int>::write("mapped_empty.bin", tree);
+
+    MappedSplayTree<int> mapped {"mapped_empty.bin"};
+    EXPECT_TRUE(mapped.empty());
+    EXPECT_EQ(mapped.begin(), mapped.end());
+    EXPECT_EQ(mapped.find(1), mapped.end());
+    EXPECT_EQ(mapped.number_less_than(1), 0);
+
+    std::remove("mapped_empty.bin");
+}
+
+TEST(MappedSplayTree, bad_file)
+{
+    EXPECT_THROW(MappedSplayTree<int> {"no_such_file.bin"}, std::runtime_error);
+
+    MappedSplayTree<long long>::write("mapped_long.bin", std::set<long long>{1, 2, 3});
+    EXPECT_THROW(MappedSplayTree<int> {"mapped_long.bin"}, std::runtime_error);
+    std::remove("mapped_long.bin");
+}
+
+TEST(MappedSplayTree, find_n_bounds_n_rank)
+{
+    std::set<int> keys {};
+    for (int i = 0; i < 1000; i++)
+        keys.insert((i * 7919) % 3001);
+    MappedSplayTree<int>::write("mapped_rank.bin", keys.begin(), keys.end());
+    MappedSplayTree<int> mapped {"mapped_rank.bin"};
+
+    for (int key = -5; key < 3010; key++)
+    {
+        auto set_itr = keys.find(key);
+        auto itr = mapped.find(key);
+        if (set_itr == keys.end())
+            EXPECT_EQ(itr, mapped.end());
+        else
+            EXPECT_EQ(*itr, key);
+
+        auto lower = keys.lower_bound(key);
+        if (lower == keys.end())
+            EXPECT_EQ(mapped.lower_bound(key), mapped.end());
+        else
+            EXPECT_EQ(*mapped.lower_bound(key), *lower);
+
+        auto upper = keys.upper_bound(key);
+        if (upper == keys.end())
+            EXPECT_EQ(mapped.upper_bound(key), mapped.end());
+        else
+            EXPECT_EQ(*mapped.upper_bound(key), *upper);
+
+        EXPECT_EQ(mapped.number_less_than(key), std::distance(keys.begin(), lower));
+        EXPECT_EQ(mapped.number_not_greater_than(key), std::distance(keys.begin(), upper));
+    }
+
+    std::remove("mapped_rank.bin");
+}
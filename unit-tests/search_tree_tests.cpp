@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <bit>
+#include <random>
+#include <set>
 #include "search_tree.hpp"
 
 using namespace Container;
@@ -188,3 +191,76 @@ TEST(SearchTree, erase)
 
     EXPECT_EQ(*set2.erase(citr1, citr2), 12);
 }
+
+TEST(SearchTree, build_from)
+{
+    std::mt19937 rand {3};
+    for (std::size_t size: {0, 1, 2, 1000, 300000})
+        for (unsigned threads: {1, 3, 4})
+        {
+            std::vector<int> keys(size);
+            for (auto& key: keys)
+                key = rand() % (size + 1);
+            std::set<int> expected(keys.begin(), keys.end());
+
+            SearchTree<int> tree {100, 200, 300};
+            tree.build_from(keys.begin(), keys.end(), threads);
+            ASSERT_EQ(tree.size(), expected.size());
+            EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+            if (expected.empty())
+                continue;
+
+            EXPECT_EQ(tree.minimum(), *expected.begin());
+            EXPECT_EQ(tree.maximum(), *expected.rbegin());
+            EXPECT_EQ(*std::prev(tree.end()), *expected.rbegin());
+            auto shape = tree.shape();
+            EXPECT_EQ(shape.size, expected.size());
+            EXPECT_EQ(shape.height, std::bit_width(expected.size()));
+            for (auto key: {-1, 0, 5, static_cast<int>(size / 2), static_cast<int>(size)})
+                EXPECT_EQ(tree.find(key) != tree.end(), expected.contains(key));
+        }
+}
+
+TEST(SearchTree, batch_lookup)
+{
+    std::mt19937 rand {11};
+    // more keys than group, so slots of descents are reused
+    std::vector<int> keys(500);
+    for (auto& key: keys)
+        key = static_cast<int>(rand() % 10010) - 5;
+
+    SearchTree<int> tree {};
+    EXPECT_EQ(tree.lower_bound_batch(keys.begin(), keys.end()), std::vector(keys.size(), tree.end()));
+    for (int i = 0; i < 3000; i++)
+        tree.insert(static_cast<int>(rand() % 10000));
+
+    auto found = tree.find_batch(keys.begin(), keys.end());
+    auto bounds = tree.lower_bound_batch(keys.begin(), keys.end());
+    ASSERT_EQ(found.size(), keys.size());
+    ASSERT_EQ(bounds.size(), keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++)
+    {
+        EXPECT_EQ(found[i], tree.find(keys[i]));
+        EXPECT_EQ(bounds[i], tree.lower_bound(keys[i]));
+    }
+}
+
+TEST(SearchTree, sorted_batch_lookup)
+{
+    std::mt19937 rand {17};
+    std::vector<int> keys(600);
+    for (auto& key: keys)
+        key = static_cast<int>(rand() % 4010) - 5;
+    std::sort(keys.begin(), keys.end());
+
+    SearchTree<int> tree {};
+    EXPECT_EQ(tree.find_sorted_batch(keys.begin(), keys.end()), std::vector(keys.size(), tree.end()));
+    for (int i = 0; i < 2000; i++)
+        tree.insert(static_cast<int>(rand() % 4000));
+
+    // repeated keys get the same node
+    auto found = tree.find_sorted_batch(keys.begin(), keys.end());
+    ASSERT_EQ(found.size(), keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++)
+        EXPECT_EQ(found[i], tree.find(keys[i]));
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace Tests
+{
+// checks size, ranks and membership of probes against std::set,
+// keys and bounds are checked too if set has iterators or kth_smallest
+template<typename Set, typename KeyT, class Cmp>
+void expect_same(const Set& set, const std::set<KeyT, Cmp>& expected, const std::vector<KeyT>& probes)
+{
+    std::vector<KeyT> sorted(expected.begin(), expected.end());
+    auto cmp = expected.key_comp();
+    ASSERT_EQ(set.size(), sorted.size());
+    if constexpr (requires {set.begin();})
+    {
+        ASSERT_TRUE(std::equal(set.begin(), set.end(), sorted.begin(), sorted.end()));
+    }
+    if constexpr (requires {set.kth_smallest(0);})
+    {
+        for (std::size_t index = 0; index < sorted.size(); index++)
+            EXPECT_EQ(set.kth_smallest(index), sorted[index]);
+    }
+
+    for (auto& key: probes)
+    {
+        auto less        = std::lower_bound(sorted.begin(), sorted.end(), key, cmp) - sorted.begin();
+        auto not_greater = std::upper_bound(sorted.begin(), sorted.end(), key, cmp) - sorted.begin();
+        EXPECT_EQ(set.number_less_than(key), less);
+        EXPECT_EQ(set.number_not_greater_than(key), not_greater);
+        EXPECT_EQ(set.contains(key), expected.contains(key));
+        if constexpr (requires {set.lower_bound(key) - set.begin();})
+        {
+            EXPECT_EQ(set.lower_bound(key) - set.begin(), less);
+            EXPECT_EQ(set.upper_bound(key) - set.begin(), not_greater);
+        }
+    }
+}
+} // namespace Tests
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+#include "sharded_splay_tree.hpp"
+
+using namespace Container;
+
+namespace
+{
+void expect_ranks(const ShardedSplayTree<int>& tree, const std::set<int>& expected, int max)
+{
+    ASSERT_EQ(tree.size(), expected.size());
+    auto sizes = tree.shard_sizes();
+    EXPECT_EQ(std::accumulate(sizes.begin(), sizes.end(), std::size_t{0}), expected.size());
+
+    for (int key = -1; key <= max; key += std::max(7, max / 500))
+    {
+        auto less = std::distance(expected.begin(), expected.lower_bound(key));
+        EXPECT_EQ(tree.number_less_than(key), less);
+        EXPECT_EQ(tree.number_not_greater_than(key), std::distance(expected.begin(), expected.upper_bound(key)));
+        EXPECT_EQ(tree.contains(key), expected.contains(key));
+        for (int width: {0, 10, 1000, 100000})
+            EXPECT_EQ(tree.count_in_range(key, key + width),
+                      std::distance(expected.lower_bound(key), expected.upper_bound(key + width)));
+    }
+}
+} // namespace
+
+TEST(ShardedSplayTree, sequential)
+{
+    EXPECT_THROW(ShardedSplayTree<int>(0), std::invalid_argument);
+
+    ShardedSplayTree<int> tree {4, 16};
+    std::set<int> expected {};
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.shards(), 1);
+
+    // sorted inserts make the last shard heavy over and over
+    for (int i = 0; i < 3000; i++)
+    {
+        EXPECT_TRUE(tree.insert(2 * i));
+        expected.insert(2 * i);
+    }
+    EXPECT_FALSE(tree.insert(0));
+    EXPECT_EQ(tree.shards(), 4);
+    expect_ranks(tree, expected, 6000);
+
+    auto sizes = tree.shard_sizes();
+    EXPECT_LE(*std::max_element(sizes.begin(), sizes.end()), 2 * 3000 / 4 + 16);
+
+    std::mt19937 rand {1};
+    for (int i = 0; i < 2000; i++)
+    {
+        int key = rand() % 6000;
+        EXPECT_EQ(tree.erase(key), expected.erase(key) == 1);
+    }
+    expect_ranks(tree, expected, 6000);
+    EXPECT_EQ(tree.count_in_range(10, 5), 0);
+}
+
+TEST(ShardedSplayTree, bulk)
+{
+    std::vector<int> keys(10000);
+    std::iota(keys.begin(), keys.end(), -5000);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{2});
+    ShardedSplayTree<int> tree(keys.begin(), keys.end(), 8, 1000);
+    EXPECT_EQ(tree.shards(), 8);
+
+    std::set<int> expected(keys.begin(), keys.end());
+    expect_ranks(tree, expected, 6000);
+}
+
+TEST(ShardedSplayTree, concurrent)
+{
+    constexpr int threads = 4, per_thread = 20000;
+    ShardedSplayTree<int> tree {threads, 256};
+
+    // every thread owns keys equal to t modulo threads and records them
+    std::vector<std::set<int>> owns(threads);
+    std::vector<std::thread> workers {};
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&tree, &own = owns[t], t]
+        {
+            std::mt19937 rand(t);
+            for (int i = 0; i < per_thread; i++)
+            {
+                int key = (i * threads + t) * 2;
+                EXPECT_EQ(tree.insert(key), own.insert(key).second);
+                if (i % 3 == 0)
+                {
+                    key = ((rand() % (i + 1)) * threads + t) * 2;
+                    EXPECT_EQ(tree.erase(key), own.erase(key) == 1);
+                }
+                key = static_cast<int>(rand() % (2 * threads * per_thread));
+                EXPECT_LE(tree.number_less_than(key), threads * per_thread);
+                tree.count_in_range(key, key + 1000);
+            }
+        });
+    for (auto& worker: workers)
+        worker.join();
+
+    std::set<int> expected {};
+    for (auto& own: owns)
+        expected.insert(own.begin(), own.end());
+    EXPECT_GT(tree.shards(), 1);
+    expect_ranks(tree, expected, 2 * threads * per_thread);
+}
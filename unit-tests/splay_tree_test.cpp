@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <bit>
+#include <random>
+#include <set>
 #include "splay_tree.hpp"
 
 using namespace Container;
@@ -285,4 +288,504 @@ TEST(SplayTree, distance)
     SplayTree<int> tree {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
     EXPECT_NE(tree.begin(), tree.end());
     EXPECT_EQ(tree.distance(tree.begin(), tree.end()), 10);
-}
\ No newline at end of file
+}
+
+TEST(SplayTree, stats)
+{
+    static_assert(std::is_empty_v<detail::StatsCounter<false>>);
+    EXPECT_EQ(detail::StatsCounter<false>{}.snapshot().comparisons, 0);
+
+    SplayTree<int> tree {};
+    ASSERT_TRUE(tree.stats_enabled);
+    for (int i = 0; i < 100; i++)
+        tree.insert(i);
+
+    auto stats = tree.stats();
+    EXPECT_EQ(stats.allocations, 100);
+    EXPECT_EQ(stats.frees, 0);
+    EXPECT_EQ(stats.descents, 100);
+    EXPECT_GT(stats.comparisons, 0);
+    // sorted keys: every new key is right son of root
+    EXPECT_EQ(stats.splays, 100);
+    EXPECT_EQ(stats.zigs, 99);
+    EXPECT_EQ(stats.rotations, 99);
+
+    tree.reset_stats();
+    tree.find(0);
+    stats = tree.stats();
+    EXPECT_EQ(stats.descents, 1);
+    EXPECT_EQ(stats.max_descent_depth, 99);
+    EXPECT_EQ(stats.zigs + stats.zig_zigs + stats.zig_zags, (stats.rotations + 1) / 2);
+    EXPECT_EQ(stats.rotations, 99);
+    EXPECT_DOUBLE_EQ(stats.rotations_per_splay(), 99.0);
+    EXPECT_DOUBLE_EQ(stats.average_descent_depth(), 99.0);
+
+    tree.reset_stats();
+    tree.erase(50);
+    tree.number_less_than(10);
+    stats = tree.stats();
+    EXPECT_EQ(stats.frees, 1);
+    EXPECT_EQ(stats.descents, 2);
+
+    // hit and miss that visit the same nodes have the same depth
+    SearchTree<int> one {5};
+    one.reset_stats();
+    one.find(5);
+    one.find(7);
+    one.lower_bound(3);
+    stats = one.stats();
+    EXPECT_EQ(stats.descents, 3);
+    EXPECT_EQ(stats.max_descent_depth, 0);
+
+    SearchTree<int> two {5, 7};
+    two.reset_stats();
+    two.find(7);
+    two.find(6);
+    two.upper_bound(8);
+    EXPECT_EQ(two.stats().descent_depth, 3);
+    EXPECT_EQ(two.stats().max_descent_depth, 1);
+}
+
+TEST(SplayTree, shape)
+{
+    SplayTree<int> empty {};
+    EXPECT_EQ(empty.shape().height, 0);
+    EXPECT_EQ(empty.sample_shape(10).height, 0);
+
+    SplayTree<int> path {};
+    for (int i = 0; i < 64; i++)
+        path.insert(i);
+
+    // sorted inserts make path: every node has only left son
+    auto shape = path.shape();
+    EXPECT_EQ(shape.size, 64);
+    EXPECT_EQ(shape.height, 64);
+    EXPECT_EQ(shape.depth_histogram, std::vector<std::size_t>(64, 1));
+    EXPECT_DOUBLE_EQ(shape.average_depth, 31.5);
+    double potential = 0;
+    for (int i = 1; i <= 64; i++)
+        potential += std::log2(i);
+    EXPECT_NEAR(shape.potential, potential, 1e-9);
+    EXPECT_GT(shape.height_ratio(), 10);
+
+    auto sampled = path.sample_shape(1000, 1);
+    EXPECT_EQ(sampled.samples, 1000);
+    EXPECT_NEAR(sampled.average_depth, 31.5, 3);
+    EXPECT_NEAR(sampled.potential, potential, 0.15 * potential);
+
+    // splaying of deepest node halves depth of path
+    path.find(0);
+    EXPECT_LT(path.shape().height, 40);
+
+    SearchTree<int> balanced {4, 2, 6, 1, 3, 5, 7};
+    auto bshape = balanced.shape();
+    EXPECT_EQ(bshape.height, 3);
+    EXPECT_EQ(bshape.depth_histogram, (std::vector<std::size_t>{1, 2, 4}));
+    EXPECT_NEAR(bshape.potential, std::log2(7) + 2 * std::log2(3), 1e-9);
+    EXPECT_NEAR(bshape.height_ratio(), 1.0, 1e-9);
+}
+
+TEST(SplayTree, recent_descent_depth)
+{
+    SplayTree<int> tree {};
+    for (int i = 0; i < 1000; i++)
+        tree.insert(i);
+    // inserts of sorted keys are shallow
+    EXPECT_LT(tree.stats().recent_descent_depth, 2);
+    tree.find(0);
+    EXPECT_GT(tree.stats().recent_descent_depth, 10);
+}
+
+TEST(SplayTree, rebalance)
+{
+    SplayTree<int> tree {};
+    EXPECT_EQ(tree.rebalance_factor(), 0);
+    EXPECT_THROW(tree.set_rebalance_factor(0.5), std::invalid_argument);
+    tree.set_rebalance_factor(2);
+
+    constexpr int size = 1 << 12;
+    for (int i = 0; i < size; i++)
+        tree.insert(i);
+    // inserts of sorted keys make path, every of them is shallow
+    EXPECT_EQ(tree.shape().height, size);
+    EXPECT_EQ(tree.stats().rebuilds, 0);
+
+    // deepest node triggers rebuild of almost whole tree: top of path is short enough
+    tree.find(0);
+    EXPECT_EQ(tree.stats().rebuilds, 1);
+    EXPECT_GT(tree.stats().rebuilt_nodes, size - 2 * 12);
+    EXPECT_LT(tree.stats().rotations, size + 64);
+    EXPECT_LE(tree.shape().height, 2 * 12 + 1);
+
+    std::vector<int> keys(tree.begin(), tree.end());
+    EXPECT_EQ(keys.size(), size);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    for (int i = 0; i < size; i += 97)
+        EXPECT_EQ(tree.number_less_than(i), i);
+
+    // path in right subtree is rebuilt alone
+    tree.reset_stats();
+    for (int i = size; i < 2 * size; i++)
+        tree.insert(i);
+    tree.find(size + size / 2);
+    tree.find(0);
+    EXPECT_LE(tree.shape().height, 2 * 13 + 1);
+    for (int i = 0; i < 2 * size; i += 89)
+        EXPECT_EQ(tree.number_not_greater_than(i), i + 1);
+    EXPECT_EQ(tree.minimum(), 0);
+    EXPECT_EQ(tree.maximum(), 2 * size - 1);
+
+    SplayTree<int> off {};
+    for (int i = 0; i < size; i++)
+        off.insert(i);
+    off.find(0);
+    EXPECT_EQ(off.stats().rebuilds, 0);
+    EXPECT_GT(off.shape().height, size / 2);
+}
+
+TEST(SplayTree, erase_n_ranks)
+{
+    for (double factor: {0.0, 1.0})
+    {
+        SplayTree<int> tree {};
+        tree.set_rebalance_factor(factor);
+        std::set<int> set {};
+        std::mt19937 rand {42};
+
+        for (int i = 0; i < 20000; i++)
+        {
+            int key = rand() % 1000;
+            if (rand() % 2)
+            {
+                tree.insert(key);
+                set.insert(key);
+            }
+            else
+            {
+                tree.erase(key);
+                set.erase(key);
+            }
+            ASSERT_EQ(tree.number_less_than(key), std::distance(set.begin(), set.lower_bound(key)));
+        }
+        EXPECT_TRUE(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+    }
+}
+
+namespace
+{
+std::set<int> random_set(std::mt19937& rand, std::size_t size, int max)
+{
+    std::set<int> set {};
+    while (set.size() < size)
+        set.insert(rand() % max);
+    return set;
+}
+
+// checks order, sizes of subtrees and links of minimum and maximum
+void expect_valid(const SplayTree<int>& tree, const std::set<int>& expected)
+{
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+    ASSERT_EQ(tree.shape().size, expected.size());
+    if (expected.empty())
+        return;
+    EXPECT_EQ(tree.minimum(), *expected.begin());
+    EXPECT_EQ(tree.maximum(), *expected.rbegin());
+    EXPECT_EQ(*std::prev(tree.end()), *expected.rbegin());
+    for (auto key: {*expected.begin(), *expected.rbegin(), (*expected.begin() + *expected.rbegin()) / 2})
+        EXPECT_EQ(tree.number_less_than(key), std::distance(expected.begin(), expected.lower_bound(key)));
+}
+} // namespace
+
+TEST(SplayTree, set_algebra)
+{
+    std::mt19937 rand {7};
+    for (auto [lhs_size, rhs_size]: {std::pair{0, 0}, {0, 50}, {50, 0}, {1, 1}, {300, 20}, {20, 300}, {1000, 1000}, {50000, 70000}})
+        for (unsigned threads: {1, 4})
+        {
+            auto lhs_set = random_set(rand, lhs_size, 4 * (lhs_size + rhs_size) + 1);
+            auto rhs_set = random_set(rand, rhs_size, 4 * (lhs_size + rhs_size) + 1);
+            SplayTree<int> lhs(lhs_set.begin(), lhs_set.end()), rhs(rhs_set.begin(), rhs_set.end());
+
+            std::set<int> expected {};
+            std::set_union(lhs_set.begin(), lhs_set.end(), rhs_set.begin(), rhs_set.end(), std::inserter(expected, expected.end()));
+            auto united = set_union(lhs, rhs, threads);
+            expect_valid(united, expected);
+            // larger tree is split by median, so total size decreases at least by quarter on every level
+            auto height = std::max(lhs.shape().height, rhs.shape().height);
+            EXPECT_LE(united.shape().height, height + std::log(expected.size() + 1) / std::log(4.0 / 3) + 2);
+
+            expected.clear();
+            std::set_intersection(lhs_set.begin(), lhs_set.end(), rhs_set.begin(), rhs_set.end(), std::inserter(expected, expected.end()));
+            expect_valid(set_intersection(lhs, rhs, threads), expected);
+
+            expected.clear();
+            std::set_difference(lhs_set.begin(), lhs_set.end(), rhs_set.begin(), rhs_set.end(), std::inserter(expected, expected.end()));
+            expect_valid(set_difference(lhs, rhs, threads), expected);
+
+            // arguments moved in give their nodes away
+            auto lhs_size_before = lhs.size();
+            auto moved = set_difference(std::move(lhs), SplayTree<int>{}, threads);
+            EXPECT_EQ(moved.size(), lhs_size_before);
+        }
+}
+
+TEST(SplayTree, set_algebra_of_paths)
+{
+    // inserts of sorted keys make paths, recursion depth doesn't depend on it
+    SplayTree<int> evens {}, thirds {};
+    for (int i = 0; i < 200000; i += 2)
+        evens.insert(i);
+    for (int i = 0; i < 200000; i += 3)
+        thirds.insert(i);
+
+    auto united = set_union(evens, thirds, 2);
+    EXPECT_EQ(united.size(), 100000 + 66667 - 33334);
+    EXPECT_EQ(united.number_less_than(60000), 40000);
+
+    auto sixths = set_intersection(std::move(evens), std::move(thirds));
+    EXPECT_EQ(sixths.size(), 33334);
+    EXPECT_EQ(sixths.number_less_than(600), 100);
+    EXPECT_TRUE(evens.empty());
+    EXPECT_TRUE(thirds.empty());
+}
+
+TEST(SplayTree, merge)
+{
+    std::mt19937 rand {11};
+    for (auto [lhs_size, rhs_size]: {std::pair{0, 0}, {0, 50}, {50, 0}, {1, 1}, {300, 20}, {20, 300}, {5000, 7000}})
+    {
+        auto lhs_set = random_set(rand, lhs_size, 4 * (lhs_size + rhs_size) + 1);
+        auto rhs_set = random_set(rand, rhs_size, 4 * (lhs_size + rhs_size) + 1);
+        SplayTree<int> lhs(lhs_set.begin(), lhs_set.end()), rhs(rhs_set.begin(), rhs_set.end());
+        if (!lhs.empty())
+            lhs.find(*lhs_set.begin());
+        auto iterator = lhs.begin();
+
+        std::set<int> expected_lhs {lhs_set}, expected_rhs {};
+        for (auto key: rhs_set)
+            if (!expected_lhs.insert(key).second)
+                expected_rhs.insert(key);
+
+        lhs.merge(rhs);
+        expect_valid(lhs, expected_lhs);
+        expect_valid(rhs, expected_rhs);
+        // nodes are not reallocated
+        if (!lhs_set.empty())
+        {
+            EXPECT_EQ(*iterator, *lhs_set.begin());
+        }
+    }
+}
+
+TEST(SplayTree, merge_disjoint)
+{
+    SplayTree<int> low {}, high {}, middle {};
+    for (int i = 0; i < 1000; i++)
+        low.insert(i);
+    for (int i = 2000; i < 3000; i++)
+        high.insert(i);
+    for (int i = 1000; i < 2000; i++)
+        middle.insert(i);
+
+    low.reset_stats();
+    low.merge(high);
+    // only maximum of low is splayed, nodes of high are not touched
+    EXPECT_EQ(low.stats().allocations, 0);
+    EXPECT_EQ(low.stats().splays, 1);
+    EXPECT_TRUE(high.empty());
+    EXPECT_EQ(high.begin(), high.end());
+
+    middle.merge(low);
+    std::set<int> expected {};
+    for (int i = 0; i < 3000; i++)
+        expected.insert(i);
+    expect_valid(middle, expected);
+    EXPECT_TRUE(low.empty());
+
+    low.merge(middle);
+    expect_valid(low, expected);
+    low.merge(low);
+    expect_valid(low, expected);
+}
+
+TEST(SplayTree, build_from)
+{
+    std::vector<int> keys(200000);
+    std::mt19937 rand {5};
+    for (auto& key: keys)
+        key = rand() % 100000;
+    std::set<int> expected(keys.begin(), keys.end());
+
+    SplayTree<int> tree {1, 2, 3};
+    tree.reset_stats();
+    tree.build_from(keys.begin(), keys.end(), 4);
+    EXPECT_EQ(tree.stats().allocations, expected.size());
+    EXPECT_EQ(tree.stats().frees, 3);
+    EXPECT_EQ(tree.shape().height, std::bit_width(expected.size()));
+    expect_valid(tree, expected);
+
+    // tree keeps working after build
+    tree.erase(*expected.begin());
+    expected.erase(expected.begin());
+    tree.insert(-5);
+    expected.insert(-5);
+    expect_valid(tree, expected);
+}
+
+TEST(SplayTree, split_off_n_kth_smallest)
+{
+    std::set<int> expected {};
+    SplayTree<int> tree {};
+    for (int i = 0; i < 1000; i++)
+    {
+        tree.insert(3 * i);
+        expected.insert(3 * i);
+    }
+    for (int i = 0; i < 1000; i += 37)
+        EXPECT_EQ(tree.kth_smallest(i), 3 * i);
+
+    for (int key: {3000, 1500, 301, 300, -1})
+    {
+        auto greater = tree.split_off(key);
+        std::set<int> expected_greater(expected.lower_bound(key), expected.end());
+        expected.erase(expected.lower_bound(key), expected.end());
+        expect_valid(tree, expected);
+        expect_valid(greater, expected_greater);
+
+        tree.merge(greater);
+        expected.merge(expected_greater);
+        expect_valid(tree, expected);
+    }
+}
+
+TEST(SplayTree, freeze)
+{
+    std::mt19937 rand {5};
+    std::set<int> expected {};
+    SplayTree<int> tree {};
+    for (int i = 0; i < 5000; i++)
+    {
+        int key = rand() % 20000;
+        tree.insert(key);
+        expected.insert(key);
+    }
+
+    auto frozen = tree.freeze();
+    ASSERT_EQ(frozen.size(), tree.size());
+    EXPECT_TRUE(std::equal(frozen.begin(), frozen.end(), expected.begin(), expected.end()));
+    for (int key = -5; key < 20005; key += 7)
+    {
+        EXPECT_EQ(frozen.number_less_than(key), tree.number_less_than(key));
+        EXPECT_EQ(frozen.count_in_range(key, key + 300),
+                  tree.number_not_greater_than(key + 300) - tree.number_less_than(key));
+    }
+}
+
+TEST(SplayTree, compress)
+{
+    SplayTree<long> tree {};
+    std::set<long> expected {};
+    std::mt19937 rand {6};
+    for (int i = 0; i < 5000; i++)
+    {
+        long key = static_cast<long>(rand() % 1000000) - 500000;
+        tree.insert(key);
+        expected.insert(key);
+    }
+
+    auto compressed = tree.compress();
+    ASSERT_EQ(compressed.size(), tree.size());
+    EXPECT_EQ(compressed.kth_smallest(0), *expected.begin());
+    EXPECT_EQ(compressed.kth_smallest(tree.size() - 1), *expected.rbegin());
+    for (long key = -500010; key < 500010; key += 97)
+    {
+        EXPECT_EQ(compressed.number_less_than(key), tree.number_less_than(key));
+        EXPECT_EQ(compressed.contains(key), expected.contains(key));
+    }
+    // keys in other order are not encoded
+    auto compressible = []<typename Set>(const Set& set) {return requires {set.compress();};};
+    EXPECT_FALSE(compressible(SplayTree<long, std::greater<long>>{}));
+    EXPECT_TRUE(compressible(tree));
+}
+
+TEST(SplayTree, learn)
+{
+    SplayTree<int> tree {};
+    std::mt19937 rand {7};
+    for (int i = 0; i < 5000; i++)
+        tree.insert(static_cast<int>(rand() % 20000));
+
+    auto learned = tree.learn(8);
+    ASSERT_EQ(learned.size(), tree.size());
+    EXPECT_EQ(learned.epsilon(), 8);
+    for (int key = -5; key < 20005; key += 7)
+        EXPECT_EQ(learned.count_in_range(key, key + 300),
+                  tree.number_not_greater_than(key + 300) - tree.number_less_than(key));
+}
+
+TEST(SplayTree, batch_lookup)
+{
+    std::mt19937 rand {13};
+    SplayTree<int> tree {};
+    for (int i = 0; i < 4000; i++)
+        tree.insert(static_cast<int>(rand() % 12000));
+    std::vector<int> sorted(tree.begin(), tree.end());
+
+    std::vector<int> keys(700);
+    for (auto& key: keys)
+        key = static_cast<int>(rand() % 12010) - 5;
+
+    for (bool splay_after: {false, true})
+    {
+        auto found  = tree.find_batch(keys.begin(), keys.end(), splay_after);
+        auto bounds = tree.lower_bound_batch(keys.begin(), keys.end(), splay_after);
+        auto ranks  = tree.rank_batch(keys.begin(), keys.end(), splay_after);
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            auto bound = std::lower_bound(sorted.begin(), sorted.end(), keys[i]);
+            auto rank  = static_cast<std::size_t>(bound - sorted.begin());
+            EXPECT_EQ(ranks[i], rank);
+            if (bound == sorted.end())
+                EXPECT_EQ(bounds[i], tree.end());
+            else
+                EXPECT_EQ(*bounds[i], *bound);
+            EXPECT_EQ(found[i] != tree.end(), bound != sorted.end() && *bound == keys[i]);
+        }
+        expect_valid(tree, std::set<int>(sorted.begin(), sorted.end()));
+    }
+}
+
+TEST(SplayTree, sorted_batch_lookup)
+{
+    std::mt19937 rand {19};
+    SplayTree<int> tree {};
+    // path after sorted inserts is as deep as tree
+    for (int i = 0; i < 3000; i += 2)
+        tree.insert(i);
+    for (int i = 0; i < 1000; i++)
+        tree.insert(static_cast<int>(rand() % 6000));
+    std::vector<int> sorted(tree.begin(), tree.end());
+
+    std::vector<int> keys(800);
+    for (auto& key: keys)
+        key = static_cast<int>(rand() % 6010) - 5;
+    std::sort(keys.begin(), keys.end());
+
+    for (bool splay_after: {false, true})
+    {
+        auto found = tree.find_sorted_batch(keys.begin(), keys.end(), splay_after);
+        auto ranks = tree.rank_sorted_batch(keys.begin(), keys.end(), splay_after);
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            auto bound = std::lower_bound(sorted.begin(), sorted.end(), keys[i]);
+            EXPECT_EQ(ranks[i], static_cast<std::size_t>(bound - sorted.begin()));
+            EXPECT_EQ(found[i] != tree.end(), bound != sorted.end() && *bound == keys[i]);
+            if (found[i] != tree.end())
+            {
+                EXPECT_EQ(*found[i], keys[i]);
+            }
+        }
+        expect_valid(tree, std::set<int>(sorted.begin(), sorted.end()));
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <cmath>
+#include <random>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Workload
+{
+
+using Random = std::mt19937_64;
+
+// same distributions of range requests as in end-to-end/test_gen.py
+enum class Distribution
+{
+    Uniform,
+    Normal,
+    Triangular,
+};
+
+inline std::string_view distribution_name(Distribution dist) noexcept
+{
+    switch (dist)
+    {
+        case Distribution::Normal:     return "normal";
+        case Distribution::Triangular: return "triangular";
+        default:                       return "uniform";
+    }
+}
+
+namespace detail
+{
+template<typename KeyT>
+KeyT randint(Random& rand, KeyT min, KeyT max)
+{
+    return std::uniform_int_distribution<KeyT>{min, std::max(min, max)}(rand);
+}
+
+// random.triangular of python
+inline double triangular(Random& rand, double low, double high, double mode)
+{
+    if (high == low)
+        return low;
+    auto u = std::uniform_real_distribution<double>{0.0, 1.0}(rand);
+    auto c = (mode - low) / (high - low);
+    if (u > c)
+    {
+        u = 1.0 - u;
+        c = 1.0 - c;
+        std::swap(low, high);
+    }
+    return low + (high - low) * std::sqrt(u * c);
+}
+} // namespace detail
+
+// num_of_keys unique keys from [0, 4 * num_of_keys] in order of generation
+template<typename KeyT = int>
+std::vector<KeyT> generate_keys(Random& rand, std::size_t num_of_keys)
+{
+    std::unordered_set<KeyT> keys_set {};
+    std::vector<KeyT> keys {};
+    keys.reserve(num_of_keys);
+    keys_set.reserve(num_of_keys);
+
+    auto max = static_cast<KeyT>(4 * num_of_keys);
+    while (keys.size() < num_of_keys)
+    {
+        auto key = detail::randint<KeyT>(rand, 0, max);
+        if (keys_set.insert(key).second)
+            keys.push_back(key);
+    }
+    return keys;
+}
+
+// pairs (left bound, right bound) of range requests over keys from [min, max],
+// generated one by one, so that traces may be longer than memory
+template<typename KeyT = int>
+class RangeRequests final
+{
+    Distribution dist_;
+    KeyT min_, max_;
+    // center and spread of requests, chosen once as in test_gen.py
+    double average_ = 0, spread_ = 0;
+    std::normal_distribution<double> normal_ {};
+public:
+    RangeRequests(Random& rand, Distribution dist, KeyT min, KeyT max)
+    :dist_ {dist}, min_ {min}, max_ {max}
+    {
+        if (dist_ == Distribution::Uniform)
+        {
+            spread_  = static_cast<KeyT>((max - min) / 5);
+            average_ = detail::randint<KeyT>(rand, min + spread_, max - spread_);
+        }
+        else if (dist_ == Distribution::Triangular)
+        {
+            average_ = detail::triangular(rand, min, max, (min + max) / 2.0);
+            spread_  = (max - min) / 4.0;
+        }
+        else
+            normal_ = std::normal_distribution<double>{max / 2.0, (max - min) / 2.0};
+    }
+
+    std::pair<KeyT, KeyT> next(Random& rand)
+    {
+        if (dist_ == Distribution::Uniform)
+        {
+            auto average = static_cast<KeyT>(average_), spread = static_cast<KeyT>(spread_);
+            auto first  = detail::randint<KeyT>(rand, average - spread, average + spread / 2);
+            auto second = detail::randint<KeyT>(rand, first, average + spread);
+            return {first, second};
+        }
+        if (dist_ == Distribution::Triangular)
+        {
+            auto first  = static_cast<KeyT>(detail::triangular(rand, average_ - spread_, average_ + spread_ - 1, average_));
+            auto second = static_cast<KeyT>(detail::triangular(rand, first, average_ + spread_, average_));
+            return {first, second};
+        }
+        // two different bounds, smaller one is left
+        auto first = static_cast<KeyT>(normal_(rand)), second = first;
+        while (second == first)
+            second = static_cast<KeyT>(normal_(rand));
+        return {std::min(first, second), std::max(first, second)};
+    }
+}; // class RangeRequests
+
+template<typename KeyT = int>
+std::vector<std::pair<KeyT, KeyT>> generate_requests(Random& rand, Distribution dist, std::size_t num_of_reqs, KeyT min, KeyT max)
+{
+    RangeRequests<KeyT> requests {rand, dist, min, max};
+    std::vector<std::pair<KeyT, KeyT>> reqs {};
+    reqs.reserve(num_of_reqs);
+    for (std::size_t i = 0; i < num_of_reqs; i++)
+        reqs.push_back(requests.next(rand));
+    return reqs;
+}
+} // namespace Workload
@@ -0,0 +1,246 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "distributions.hpp"
+
+namespace Workload
+{
+
+// order in which keys are inserted in tree
+enum class KeyOrder
+{
+    Random,
+    Sorted,  // builds path-shaped splay tree
+    Reverse,
+};
+
+template<typename KeyT>
+void order_keys(Random& rand, std::vector<KeyT>& keys, KeyOrder order)
+{
+    if (order == KeyOrder::Sorted)
+        std::sort(keys.begin(), keys.end());
+    else if (order == KeyOrder::Reverse)
+        std::sort(keys.begin(), keys.end(), std::greater<KeyT>{});
+    else
+        std::shuffle(keys.begin(), keys.end(), rand);
+}
+
+// Zipf distribution on {0, ..., n - 1}: P(k) ~ 1 / (k + 1)^skew.
+// Rejection-inversion sampling (Hormann, Derflinger), O(1) per sample without tables
+class ZipfSampler final
+{
+    double skew_;
+    double h_integral_x1_, h_integral_n_, s_;
+    std::uint64_t n_;
+
+    // log1p(x) / x and expm1(x) / x, exact near zero
+    static double helper1(double x) noexcept
+    {
+        return (std::abs(x) > 1e-8) ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+    static double helper2(double x) noexcept
+    {
+        return (std::abs(x) > 1e-8) ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+    }
+
+    double h(double x) const noexcept {return std::exp(-skew_ * std::log(x));}
+
+    double h_integral(double x) const noexcept
+    {
+        auto log_x = std::log(x);
+        return helper2((1.0 - skew_) * log_x) * log_x;
+    }
+
+    double h_integral_inverse(double x) const noexcept
+    {
+        auto t = std::max(-1.0, x * (1.0 - skew_));
+        return std::exp(helper1(t) * x);
+    }
+public:
+    ZipfSampler(std::uint64_t n, double skew)
+    :skew_ {skew}, n_ {n}
+    {
+        if (n == 0 || skew <= 0)
+            throw std::invalid_argument{"ZipfSampler: need n > 0 and skew > 0"};
+        h_integral_x1_ = h_integral(1.5) - 1.0;
+        h_integral_n_  = h_integral(n + 0.5);
+        s_ = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+    }
+
+    std::uint64_t operator()(Random& rand) const
+    {
+        std::uniform_real_distribution<double> uniform {0.0, 1.0};
+        for (;;)
+        {
+            auto u = h_integral_n_ + uniform(rand) * (h_integral_x1_ - h_integral_n_);
+            auto x = h_integral_inverse(u);
+            auto k = std::clamp<double>(std::floor(x + 0.5), 1.0, static_cast<double>(n_));
+            if (k - x <= s_ || u >= h_integral(k + 0.5) - h(k))
+                return static_cast<std::uint64_t>(k) - 1;
+        }
+    }
+}; // class ZipfSampler
+
+// patterns of requests, all of them except distributions of test_gen.py
+// choose key by rank k and request range [key_k, key_k + width]
+enum class Pattern
+{
+    // same values as in Distribution
+    Uniform,
+    Normal,
+    Triangular,
+    Zipf,        // rank of key has Zipf distribution, hot keys are scattered over key space
+    Sequential,  // ranks 0, 1, 2, ... (best case of splay tree)
+    Reverse,     // ranks n - 1, n - 2, ...
+    WorkingSet,  // uniform over small random set of keys, set is replaced every period
+    HotBurst,    // uniform with bursts of requests to one hot key
+    BitReversal, // ranks in bit-reversal permutation: no locality for splaying to exploit
+};
+
+struct PatternParams
+{
+    double skew = 0.99;
+    std::uint64_t width  = 0;
+    std::uint64_t window = 1024;
+    std::uint64_t period = 100000;
+    std::uint64_t burst  = 1000;
+    double burst_probability = 0.001;
+};
+
+inline Pattern pattern_from_name(std::string_view name)
+{
+    constexpr std::pair<std::string_view, Pattern> names[] = {
+        {"uniform", Pattern::Uniform},       {"normal", Pattern::Normal},
+        {"triangular", Pattern::Triangular}, {"zipf", Pattern::Zipf},
+        {"sequential", Pattern::Sequential}, {"reverse", Pattern::Reverse},
+        {"working-set", Pattern::WorkingSet}, {"hot-burst", Pattern::HotBurst},
+        {"bit-reversal", Pattern::BitReversal},
+    };
+    for (auto [pattern_name, pattern]: names)
+        if (pattern_name == name)
+            return pattern;
+    throw std::invalid_argument{"unknown pattern " + std::string{name}};
+}
+
+// stream of range requests over sorted keys
+template<typename KeyT>
+class RequestStream final
+{
+    const std::vector<KeyT>& keys_;
+    Pattern pattern_;
+    PatternParams params_;
+
+    std::optional<RangeRequests<KeyT>> ranges_ {};
+    std::optional<ZipfSampler> zipf_ {};
+    // permutation of ranks: zipf ranks to keys, or current working set
+    std::vector<std::uint64_t> ranks_ {};
+
+    std::uint64_t counter_ = 0;
+    // hot key and remaining requests of current burst
+    std::uint64_t hot_ = 0, burst_left_ = 0;
+    int bits_ = 0;
+
+    std::uint64_t uniform_rank(Random& rand) const
+    {
+        return std::uniform_int_distribution<std::uint64_t>{0, keys_.size() - 1}(rand);
+    }
+
+    void shift_working_set(Random& rand)
+    {
+        for (auto& rank: ranks_)
+            rank = uniform_rank(rand);
+    }
+
+    std::uint64_t next_rank(Random& rand)
+    {
+        auto n = keys_.size();
+        switch (pattern_)
+        {
+            case Pattern::Zipf:
+                return ranks_[(*zipf_)(rand)];
+            case Pattern::Sequential:
+                return counter_++ % n;
+            case Pattern::Reverse:
+                return n - 1 - counter_++ % n;
+            case Pattern::WorkingSet:
+                if (counter_++ % params_.period == 0)
+                    shift_working_set(rand);
+                return ranks_[std::uniform_int_distribution<std::size_t>{0, ranks_.size() - 1}(rand)];
+            case Pattern::HotBurst:
+                if (burst_left_)
+                {
+                    burst_left_--;
+                    return hot_;
+                }
+                if (std::bernoulli_distribution{params_.burst_probability}(rand))
+                {
+                    hot_ = uniform_rank(rand);
+                    burst_left_ = params_.burst;
+                }
+                return uniform_rank(rand);
+            default: // BitReversal
+                for (;;)
+                {
+                    auto rank = reverse_bits(counter_++ & ((std::uint64_t{1} << bits_) - 1));
+                    if (rank < n)
+                        return rank;
+                }
+        }
+    }
+
+    std::uint64_t reverse_bits(std::uint64_t value) const noexcept
+    {
+        std::uint64_t reversed = 0;
+        for (int i = 0; i < bits_; i++, value >>= 1)
+            reversed = (reversed << 1) | (value & 1);
+        return reversed;
+    }
+public:
+    RequestStream(Random& rand, const std::vector<KeyT>& sorted_keys, Pattern pattern, const PatternParams& params = {})
+    :keys_ {sorted_keys}, pattern_ {pattern}, params_ {params}
+    {
+        if (keys_.empty())
+            throw std::invalid_argument{"RequestStream: no keys"};
+
+        switch (pattern_)
+        {
+            case Pattern::Uniform:
+            case Pattern::Normal:
+            case Pattern::Triangular:
+                ranges_.emplace(rand, static_cast<Distribution>(pattern_), keys_.front(), keys_.back());
+                break;
+            case Pattern::Zipf:
+                zipf_.emplace(keys_.size(), params_.skew);
+                ranks_.resize(keys_.size());
+                for (std::size_t i = 0; i < ranks_.size(); i++)
+                    ranks_[i] = i;
+                std::shuffle(ranks_.begin(), ranks_.end(), rand);
+                break;
+            case Pattern::WorkingSet:
+                ranks_.resize(std::max<std::uint64_t>(1, params_.window));
+                params_.period = std::max<std::uint64_t>(1, params_.period);
+                break;
+            case Pattern::BitReversal:
+                bits_ = std::bit_width(keys_.size() - 1);
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::pair<KeyT, KeyT> next(Random& rand)
+    {
+        if (ranges_)
+            return ranges_->next(rand);
+        auto key = keys_[next_rank(rand)];
+        return {key, static_cast<KeyT>(key + params_.width)};
+    }
+}; // class RequestStream
+} // namespace Workload
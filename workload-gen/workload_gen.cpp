@@ -0,0 +1,165 @@
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "generators.hpp"
+#include "fast_io.hpp"
+#include "workload.hpp"
+
+namespace
+{
+
+struct Options
+{
+    std::uint64_t num_of_keys = 0, num_of_reqs = 0;
+    std::string file_name {};
+    Workload::KeyOrder key_order = Workload::KeyOrder::Random;
+    Workload::Pattern pattern = Workload::Pattern::Uniform;
+    Workload::PatternParams params {};
+    std::uint64_t seed = 42;
+    bool binary = false, int64 = false;
+};
+
+constexpr std::string_view usage =
+    "Usage: workload_gen --keys N --reqs M --out FILE [--binary] [--int64] [--seed S]\n"
+    "                    [--key-order random|sorted|reverse]\n"
+    "                    [--pattern uniform|normal|triangular|zipf|sequential|reverse|\n"
+    "                               working-set|hot-burst|bit-reversal]\n"
+    "                    [--skew S] [--width W] [--window W] [--period P] [--burst B] [--burst-prob P]\n";
+
+Options parse_options(int argc, char** argv)
+{
+    Options opts {};
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg {argv[i]};
+        if (arg == "--binary")
+        {
+            opts.binary = true;
+            continue;
+        }
+        if (arg == "--int64")
+        {
+            opts.int64 = true;
+            continue;
+        }
+        if (i + 1 == argc)
+            throw std::invalid_argument{"no value of " + std::string{arg}};
+
+        std::string value {argv[++i]};
+        if (arg == "--keys")
+            opts.num_of_keys = std::stoull(value);
+        else if (arg == "--reqs")
+            opts.num_of_reqs = std::stoull(value);
+        else if (arg == "--out")
+            opts.file_name = value;
+        else if (arg == "--seed")
+            opts.seed = std::stoull(value);
+        else if (arg == "--key-order")
+            opts.key_order = (value == "sorted")  ? Workload::KeyOrder::Sorted :
+                             (value == "reverse") ? Workload::KeyOrder::Reverse : Workload::KeyOrder::Random;
+        else if (arg == "--pattern")
+            opts.pattern = Workload::pattern_from_name(value);
+        else if (arg == "--skew")
+            opts.params.skew = std::stod(value);
+        else if (arg == "--width")
+            opts.params.width = std::stoull(value);
+        else if (arg == "--window")
+            opts.params.window = std::stoull(value);
+        else if (arg == "--period")
+            opts.params.period = std::stoull(value);
+        else if (arg == "--burst")
+            opts.params.burst = std::stoull(value);
+        else if (arg == "--burst-prob")
+            opts.params.burst_probability = std::stod(value);
+        else
+            throw std::invalid_argument{"unknown option " + std::string{arg}};
+    }
+    if (!opts.num_of_keys || opts.file_name.empty())
+        throw std::invalid_argument{"--keys and --out are required"};
+    return opts;
+}
+
+// output is flushed by blocks, traces may be larger than memory
+constexpr std::size_t flush_size = 1 << 22;
+
+template<typename KeyT>
+void put(Task::OutputBuffer& output, KeyT value, bool binary)
+{
+    if (binary)
+        output.write(&value, sizeof(value));
+    else
+    {
+        output.write(value);
+        output.write(' ');
+    }
+    if (output.size() > flush_size)
+        output.flush();
+}
+
+template<typename KeyT>
+void generate(const Options& opts, int fd)
+{
+    Workload::Random rand {opts.seed};
+    Task::OutputBuffer output {fd, 2 * flush_size};
+
+    auto keys = Workload::generate_keys<KeyT>(rand, opts.num_of_keys);
+    if (opts.binary)
+    {
+        Task::BinaryHeader header {};
+        std::memcpy(header.magic_, Task::BinaryHeader::magic, sizeof(header.magic_));
+        header.key_size_    = sizeof(KeyT);
+        header.num_of_keys_ = opts.num_of_keys;
+        header.num_of_reqs_ = opts.num_of_reqs;
+        output.write(&header, sizeof(header));
+    }
+    else
+        put(output, opts.num_of_keys, false);
+
+    Workload::order_keys(rand, keys, opts.key_order);
+    for (auto key: keys)
+        put(output, key, opts.binary);
+
+    if (!opts.binary)
+        put(output, opts.num_of_reqs, false);
+
+    std::sort(keys.begin(), keys.end());
+    Workload::RequestStream<KeyT> requests {rand, keys, opts.pattern, opts.params};
+    for (std::uint64_t i = 0; i < opts.num_of_reqs; i++)
+    {
+        auto [left, right] = requests.next(rand);
+        put(output, left, opts.binary);
+        put(output, right, opts.binary);
+    }
+    if (!opts.binary)
+        output.write('\n');
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opts {};
+    try
+    {
+        opts = parse_options(argc, argv);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << '\n' << usage;
+        return 1;
+    }
+
+    int fd = ::open(opts.file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        std::cerr << "Can't open " << opts.file_name << std::endl;
+        return 1;
+    }
+
+    if (opts.int64)
+        generate<std::int64_t>(opts, fd);
+    else
+        generate<std::int32_t>(opts, fd);
+    ::close(fd);
+    return 0;
+}